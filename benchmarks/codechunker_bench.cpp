@@ -0,0 +1,101 @@
+// Mide DeepSeekCodeChunker sobre C++ y QML sintéticos de 1 KB a 5 MB y
+// comprueba que las unidades cubren el fichero sin huecos.
+
+#include "deepseekcodechunker.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+QByteArray makeCpp(qsizetype size)
+{
+    static const QByteArray sample =
+        "// Petición de análisis: \"{\" dentro de un comentario\n"
+        "class Request%1 : public QObject\n{\n    Q_OBJECT\npublic:\n"
+        "    explicit Request%1(QObject *parent = nullptr);\n    int id() const { return m_id; }\n"
+        "private:\n    int m_id = 1'000;\n};\n\n"
+        "#define CHECK_%1(x) \\\n    if (!(x)) { return; }\n\n"
+        "Request%1::Request%1(QObject *parent)\n    : QObject(parent)\n{\n"
+        "    const char *json = R\"({\"model\": \"}\"})\";\n"
+        "    connect(this, &QObject::destroyed, this, [] { qDebug() << '}'; });\n}\n\n";
+
+    QByteArray source;
+    source.reserve(size + 1024);
+    source += "#include <QObject>\n\nnamespace DeepSeekAI {\n\n";
+    for (int i = 0; source.size() < size; ++i)
+        source += QByteArray(sample).replace("%1", QByteArray::number(i));
+    source += "} // namespace DeepSeekAI\n";
+    return source;
+}
+
+QByteArray makeQml(qsizetype size)
+{
+    static const QByteArray sample =
+        "    property int count%1: 0\n"
+        "    function update%1(value) {\n        count%1 = value + `${value}}`.length\n    }\n"
+        "    Rectangle {\n        id: box%1\n        anchors { fill: parent }\n"
+        "        onClicked: { console.log(\"}\") }\n    }\n";
+
+    QByteArray source;
+    source.reserve(size + 1024);
+    source += "import QtQuick\n\nItem {\n";
+    for (int i = 0; source.size() < size; ++i)
+        source += QByteArray(sample).replace("%1", QByteArray::number(i));
+    source += "}\n";
+    return source;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    out << "language | bytes | units | tokens | ms | MB/s\n";
+
+    const QList<qsizetype> sizes = {1024, 100 * 1024, 1024 * 1024, 5 * 1024 * 1024};
+    for (const auto language : {DeepSeekCodeChunker::Cpp, DeepSeekCodeChunker::Qml}) {
+        for (qsizetype size : sizes) {
+            const QByteArray source = language == DeepSeekCodeChunker::Cpp ? makeCpp(size)
+                                                                            : makeQml(size);
+            const int iterations = size >= 1024 * 1024 ? 5 : (size >= 100 * 1024 ? 50 : 5000);
+
+            for (const bool countTokens : {false, true}) {
+                QList<DeepSeekCodeChunker::Unit> units;
+                QElapsedTimer timer;
+                timer.start();
+                for (int i = 0; i < iterations; ++i)
+                    units = DeepSeekCodeChunker::split(source, language, countTokens);
+                const double ms = double(timer.nsecsElapsed()) / 1e6 / iterations;
+
+                qsizetype covered = 0;
+                qint64 tokens = 0;
+                for (const DeepSeekCodeChunker::Unit &unit : std::as_const(units)) {
+                    if (unit.begin != covered) {
+                        out << "gap at byte " << covered << "\n";
+                        return 1;
+                    }
+                    covered = unit.end;
+                    tokens += unit.tokens;
+                }
+                if (covered != source.size()) {
+                    out << "units end at " << covered << " of " << source.size() << "\n";
+                    return 1;
+                }
+
+                out << (language == DeepSeekCodeChunker::Cpp ? "C++" : "QML") << " | "
+                    << source.size() << " | " << units.size() << " | "
+                    << (countTokens ? QString::number(tokens) : QString("-")) << " | "
+                    << QString::number(ms, 'f', 3) << " | "
+                    << QString::number(double(source.size()) / 1e6 / (ms / 1000), 'f', 0) << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+// Benchmark del completado en línea contra el servidor simulado (en un
+// hilo propio) o contra --url.
+//
+// DeepSeekInlineCompletion depende del editor de Qt Creator, así que aquí
+// se reproduce su política con las clases que solo necesitan Qt: un
+// "usuario" escribe a ráfagas, cada pulsación cancela la petición en curso
+// salvo que siga su texto, DeepSeekCompletionCache sirve lo ya propuesto y
+// tras DebounceMs sin escribir se pide un fill-in-the-middle en streaming.
+// La latencia se mide desde la última pulsación hasta el primer texto
+// visible, que es lo que nota el usuario.
+
+#include "deepseekcompletioncache.h"
+#include "deepseekinlinecompletion.h"
+#include "deepseekpayloadwriter.h"
+#include "deepseekrequest.h"
+#include "mockdeepseekserver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+qint64 percentile(QList<qint64> values, double p)
+{
+    if (values.isEmpty())
+        return -1;
+    std::sort(values.begin(), values.end());
+    const qsizetype index = qBound<qsizetype>(0, qsizetype(std::ceil(p * values.size())) - 1,
+                                              values.size() - 1);
+    return values.at(index);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("deepseek_completion_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Inline completion latency and cache benchmark");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"url", "Base URL to test (default: in-process mock server).", "url"},
+        {"keys", "Keystrokes to simulate.", "count", "400"},
+        {"burst", "Keystrokes between typing pauses.", "count", "8"},
+        {"key-interval", "Milliseconds between keystrokes in a burst.", "ms", "70"},
+        {"pause", "Milliseconds of each typing pause.", "ms", "600"},
+        {"follow", "Fraction of keystrokes that type the visible suggestion.", "fraction", "0.7"},
+        {"debounce", "Milliseconds without typing before a request.", "ms",
+         QString::number(DeepSeekInlineCompletion::DebounceMs)},
+        {"budget", "Target p95 to first visible token.", "ms", "300"},
+        {"latency", "Mock: milliseconds before the response headers.", "ms", "50"},
+        {"tokens-per-second", "Mock: generation speed.", "rate", "200"},
+        {"tokens", "Mock: tokens per completion.", "count", "24"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+
+    // 1. Servidor simulado en su propio hilo para no competir con el cliente
+    QThread serverThread;
+    MockDeepSeekServer *server = nullptr;
+    QString baseUrl = parser.value("url");
+    if (baseUrl.isEmpty()) {
+        MockDeepSeekServer::Options options;
+        options.latencyMs = parser.value("latency").toInt();
+        options.tokensPerSecond = parser.value("tokens-per-second").toDouble();
+        options.tokensPerResponse = parser.value("tokens").toInt();
+
+        server = new MockDeepSeekServer(options);
+        server->moveToThread(&serverThread);
+        QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+        serverThread.start();
+
+        quint16 port = 0;
+        QMetaObject::invokeMethod(server, [server, &port]() {
+            if (server->listen())
+                port = server->port();
+        }, Qt::BlockingQueuedConnection);
+        if (port == 0) {
+            out << "mock server cannot listen\n";
+            serverThread.quit();
+            serverThread.wait();
+            return 1;
+        }
+        baseUrl = QString("http://127.0.0.1:%1").arg(port);
+    } else if (baseUrl.endsWith("/v1")) {
+        baseUrl.chop(3);
+    }
+
+    // 2. Misma cadena que DeepSeekTool::requestCompletion
+    const int totalKeys = qMax(1, parser.value("keys").toInt());
+    const int burst = qMax(1, parser.value("burst").toInt());
+    const int keyIntervalMs = parser.value("key-interval").toInt();
+    const int pauseMs = parser.value("pause").toInt();
+    const double follow = parser.value("follow").toDouble();
+    const int budgetMs = parser.value("budget").toInt();
+
+    // Como en el plugin, sin planificador: el token bucket de Generate/Fix
+    // no limita los completados
+    QNetworkAccessManager manager;
+
+    QNetworkRequest request(QUrl(baseUrl + "/beta/completions"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", "Bearer benchmark");
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    // 3. Estado del completado, como en DeepSeekInlineCompletion
+    const QString suffix = "\n}\n";
+    QString prefix = "int main(int argc, char *argv[])\n{\n    ";
+    DeepSeekCompletionCache cache;
+    QPointer<DeepSeekRequest> inFlight;
+    QString requestPrefix;
+    QString received;
+    QString visible;
+    int typed = 0;
+    bool firstVisible = false;
+    QElapsedTimer lastKey;
+
+    QList<qint64> firstVisibleMs;
+    int sent = 0;
+    int cancelled = 0;
+    int failed = 0;
+    int continued = 0;      // pulsaciones servidas por la petición en curso
+    quint64 lastId = 0;
+
+    QTimer debounce;
+    debounce.setSingleShot(true);
+    debounce.setInterval(parser.value("debounce").toInt());
+
+    auto cancel = [&]() {
+        if (DeepSeekRequest *handle = inFlight.data()) {
+            inFlight = nullptr;
+            handle->cancel();
+            ++cancelled;
+        }
+        received.clear();
+        typed = 0;
+    };
+
+    QObject::connect(&debounce, &QTimer::timeout, &app, [&]() {
+        if (inFlight)
+            return;
+        FimCompletionRequest fim;
+        fim.prompt = prefix.right(DeepSeekInlineCompletion::PrefixChars);
+        fim.suffix = suffix;
+
+        auto *handle = new DeepSeekRequest(++lastId, "inline-completion");
+        handle->setNetworkRequest(request, DeepSeekPayloadWriter::write(fim), true);
+        handle->setTimeout(5000);
+        inFlight = handle;
+        requestPrefix = prefix;
+        received.clear();
+        typed = 0;
+        firstVisible = false;
+        ++sent;
+
+        QObject::connect(handle, &DeepSeekRequest::partialContent, &app, [&, handle]() {
+            if (handle != inFlight)
+                return;
+            received = handle->content();
+            visible = received.mid(typed);
+            if (!firstVisible && !visible.isEmpty()) {
+                firstVisible = true;
+                firstVisibleMs.append(lastKey.elapsed());
+            }
+        });
+        QObject::connect(handle, &DeepSeekRequest::finished, &app,
+                         [&, handle](const QString &content) {
+            if (handle != inFlight)
+                return;
+            inFlight = nullptr;
+            cache.insert(requestPrefix, QString(), content);
+        });
+        QObject::connect(handle, &DeepSeekRequest::failed, &app, [&, handle]() {
+            ++failed;
+            if (handle == inFlight)
+                inFlight = nullptr;
+        });
+
+        handle->start(&manager);
+    });
+
+    auto keystroke = [&](QChar c) {
+        prefix += c;
+        lastKey.start();
+        visible.clear();
+
+        if (inFlight) {
+            const int t = DeepSeekCompletionCache::typedLength(
+                QStringView(requestPrefix).right(DeepSeekCompletionCache::KeyChars), received,
+                prefix);
+            if (t >= 0) {
+                typed = t;
+                visible = received.mid(t);
+                ++continued;
+                return;
+            }
+            cancel();
+        }
+
+        visible = cache.lookup(prefix, QString());
+        if (!visible.isEmpty()) {
+            debounce.stop();
+            return;
+        }
+        debounce.start();
+    };
+
+    // 4. El usuario: sigue la sugerencia visible o escribe otra cosa
+    static const QString other = "abcdefxyz_;( ";
+    int keys = 0;
+    std::function<void()> nextKey = [&]() {
+        if (keys == totalKeys) {
+            debounce.stop();
+            cancel();
+            app.quit();
+            return;
+        }
+        QRandomGenerator *random = QRandomGenerator::global();
+        const QChar c = !visible.isEmpty() && random->generateDouble() < follow
+                            ? visible.at(0)
+                            : other.at(random->bounded(int(other.size())));
+        keystroke(c);
+        ++keys;
+        QTimer::singleShot(keys % burst == 0 ? pauseMs : keyIntervalMs, &app, nextKey);
+    };
+    QTimer::singleShot(0, &app, nextKey);
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+    app.exec();
+    const qint64 wallMs = wallClock.elapsed();
+
+    // 5. Resultados
+    const qint64 p95 = percentile(firstVisibleMs, 0.95);
+    out << "keystrokes " << totalKeys << ", burst " << burst << ", key interval "
+        << keyIntervalMs << " ms, pause " << pauseMs << " ms, debounce "
+        << debounce.interval() << " ms, " << baseUrl << "\n"
+        << "requests      " << sent << " sent, " << cancelled << " cancelled as stale, "
+        << failed << " failed\n"
+        << "first visible p50 " << percentile(firstVisibleMs, 0.50)
+        << "  p95 " << p95
+        << "  p99 " << percentile(firstVisibleMs, 0.99) << " ms after the last keystroke\n"
+        << "no request    " << cache.hits() << " keystrokes from the prefix cache, "
+        << continued << " from the request in flight\n"
+        << "budget        p95 " << p95 << " ms of " << budgetMs << " ms: "
+        << (p95 >= 0 && p95 <= budgetMs ? "ok" : "exceeded") << "\n"
+        << "wall clock    " << wallMs << " ms\n";
+
+    if (server) {
+        serverThread.quit();
+        serverThread.wait();
+    }
+
+    return failed == 0 ? 0 : 1;
+}
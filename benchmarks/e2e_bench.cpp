@@ -0,0 +1,210 @@
+// Benchmark de extremo a extremo del camino de peticiones: payload,
+// planificador, DeepSeekRequest, streaming y parseo de respuestas contra
+// el servidor simulado (en un hilo propio) o contra --url.
+//
+// DeepSeekTool depende de Qt Creator, así que aquí se monta la misma
+// cadena que usa DeepSeekTool::submitRequest con las clases que solo
+// necesitan Qt.
+
+#include "deepseekpayloadwriter.h"
+#include "deepseekrequest.h"
+#include "deepseekrequestscheduler.h"
+#include "mockdeepseekserver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+qint64 peakRssKb()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(Q_OS_MACOS)
+    return qint64(usage.ru_maxrss / 1024); // bytes en macOS
+#else
+    return qint64(usage.ru_maxrss);        // KB en Linux
+#endif
+#endif
+}
+
+qint64 percentile(QList<qint64> values, double p)
+{
+    if (values.isEmpty())
+        return -1;
+    std::sort(values.begin(), values.end());
+    const qsizetype index = qBound<qsizetype>(0, qsizetype(std::ceil(p * values.size())) - 1,
+                                              values.size() - 1);
+    return values.at(index);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("deepseek_e2e_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("End-to-end latency/throughput benchmark of the request path");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"url", "Base URL to test (default: in-process mock server).", "url"},
+        {"requests", "Number of requests.", "count", "200"},
+        {"concurrency", "Concurrent requests per endpoint.", "count", "8"},
+        {"no-stream", "Disable SSE streaming."},
+        {"prompt-size", "Prompt size in characters.", "chars", "4096"},
+        {"latency", "Mock: milliseconds before the response headers.", "ms", "50"},
+        {"tokens-per-second", "Mock: generation speed.", "rate", "500"},
+        {"tokens", "Mock: tokens per response.", "count", "100"},
+        {"error-rate", "Mock: fraction of 500 responses.", "fraction", "0"},
+        {"rate-limit-rate", "Mock: fraction of 429 responses.", "fraction", "0"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+
+    // 1. Servidor simulado en su propio hilo para no competir con el cliente
+    QThread serverThread;
+    MockDeepSeekServer *server = nullptr;
+    QString baseUrl = parser.value("url");
+    if (baseUrl.isEmpty()) {
+        MockDeepSeekServer::Options options;
+        options.latencyMs = parser.value("latency").toInt();
+        options.tokensPerSecond = parser.value("tokens-per-second").toDouble();
+        options.tokensPerResponse = parser.value("tokens").toInt();
+        options.errorRate = parser.value("error-rate").toDouble();
+        options.rateLimitRate = parser.value("rate-limit-rate").toDouble();
+        options.retryAfterSeconds = 0;
+
+        server = new MockDeepSeekServer(options);
+        server->moveToThread(&serverThread);
+        QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+        serverThread.start();
+
+        quint16 port = 0;
+        QMetaObject::invokeMethod(server, [server, &port]() {
+            if (server->listen())
+                port = server->port();
+        }, Qt::BlockingQueuedConnection);
+        if (port == 0) {
+            out << "mock server cannot listen\n";
+            serverThread.quit();
+            serverThread.wait();
+            return 1;
+        }
+        baseUrl = QString("http://127.0.0.1:%1/v1").arg(port);
+    }
+
+    // 2. Misma cadena que DeepSeekTool::submitRequest
+    const int total = qMax(1, parser.value("requests").toInt());
+    const int concurrency = qMax(1, parser.value("concurrency").toInt());
+    const bool streaming = !parser.isSet("no-stream");
+
+    QNetworkAccessManager manager;
+    DeepSeekRequestScheduler scheduler(&manager);
+    scheduler.setMaxConcurrentPerEndpoint(concurrency);
+    scheduler.setRateLimit(0, 0);
+    scheduler.setMaxAttempts(4);
+
+    ChatCompletionRequest chat;
+    chat.messages.append({"user", QString(parser.value("prompt-size").toInt(), QLatin1Char('x'))});
+    chat.stream = streaming;
+    const QByteArray payload = DeepSeekPayloadWriter::write(chat);
+
+    QNetworkRequest request(QUrl(baseUrl + "/chat/completions"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", "Bearer benchmark");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    if (streaming)
+        request.setRawHeader("Accept", "text/event-stream");
+
+    QList<qint64> latencies;
+    QList<qint64> firstTokens;
+    int completed = 0;
+    int failed = 0;
+    int retries = 0;
+    qint64 cacheHitTokens = 0;
+    qint64 cacheMissTokens = 0;
+
+    QObject::connect(&scheduler, &DeepSeekRequestScheduler::retryScheduled,
+                     &app, [&retries]() { ++retries; });
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    for (int i = 0; i < total; ++i) {
+        auto *handle = new DeepSeekRequest(quint64(i + 1), "benchmark");
+        handle->setNetworkRequest(request, payload, streaming);
+
+        QObject::connect(handle, &DeepSeekRequest::finished, &app, [&, handle]() {
+            latencies.append(handle->totalMs());
+            if (handle->firstTokenMs() >= 0)
+                firstTokens.append(handle->firstTokenMs());
+            const ChatCompletionUsage usage = handle->usage();
+            if (usage.promptCacheHitTokens >= 0 && usage.promptCacheMissTokens >= 0) {
+                cacheHitTokens += usage.promptCacheHitTokens;
+                cacheMissTokens += usage.promptCacheMissTokens;
+            }
+        });
+        QObject::connect(handle, &DeepSeekRequest::failed, &app, [&failed]() { ++failed; });
+        QObject::connect(handle, &DeepSeekRequest::completed, &app, [&]() {
+            if (++completed == total)
+                app.quit();
+        });
+
+        scheduler.enqueue(handle, DeepSeekRequestScheduler::Normal);
+    }
+
+    app.exec();
+    const qint64 wallMs = wallClock.elapsed();
+
+    // 3. Resultados
+    out << "requests " << total << ", concurrency " << concurrency
+        << (streaming ? ", streaming" : ", no streaming") << ", " << baseUrl << "\n"
+        << "ok " << latencies.size() << ", failed " << failed << ", retries " << retries << "\n"
+        << "latency ms    p50 " << percentile(latencies, 0.50)
+        << "  p95 " << percentile(latencies, 0.95)
+        << "  p99 " << percentile(latencies, 0.99) << "\n"
+        << "first token   p50 " << percentile(firstTokens, 0.50)
+        << "  p95 " << percentile(firstTokens, 0.95)
+        << "  p99 " << percentile(firstTokens, 0.99) << "\n"
+        << "throughput    " << QString::number(total * 1000.0 / qMax<qint64>(1, wallMs), 'f', 1)
+        << " req/s (" << wallMs << " ms)\n"
+        << "context cache " << (cacheHitTokens + cacheMissTokens > 0
+                                    ? 100 * cacheHitTokens / (cacheHitTokens + cacheMissTokens)
+                                    : 0)
+        << "% hit (" << cacheHitTokens << " of " << cacheHitTokens + cacheMissTokens
+        << " prompt tokens)\n"
+        << "peak RSS      " << peakRssKb() << " KB\n";
+
+    if (server) {
+        serverThread.quit();
+        serverThread.wait();
+    }
+
+    return failed == 0 ? 0 : 1;
+}
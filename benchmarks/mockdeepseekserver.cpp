@@ -0,0 +1,293 @@
+#include "mockdeepseekserver.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <iterator>
+#include <memory>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+QByteArray errorJson(const QByteArray &message, const QByteArray &type)
+{
+    return "{\"error\":{\"message\":\"" + message + "\",\"type\":\"" + type
+           + "\",\"param\":null,\"code\":null}}";
+}
+
+void writeChunk(QTcpSocket *socket, const QByteArray &data)
+{
+    socket->write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+}
+
+} // namespace
+
+MockDeepSeekServer::MockDeepSeekServer(const Options &options, QObject *parent)
+    : QObject(parent),
+      m_options(options)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &MockDeepSeekServer::onNewConnection);
+}
+
+bool MockDeepSeekServer::listen(const QHostAddress &address, quint16 port)
+{
+    return m_server.listen(address, port);
+}
+
+void MockDeepSeekServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_connections.insert(socket, Connection());
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            m_connections[socket].buffer += socket->readAll();
+            processBuffer(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockDeepSeekServer::processBuffer(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end() || it->busy)
+        return;
+
+    const qsizetype headerEnd = it->buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0)
+        return;
+
+    const QList<QByteArray> lines = it->buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    qsizetype contentLength = 0;
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines.at(i).trimmed();
+        const qsizetype colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length")
+            contentLength = line.mid(colon + 1).trimmed().toLongLong();
+    }
+
+    const qsizetype requestSize = headerEnd + 4 + contentLength;
+    if (it->buffer.size() < requestSize)
+        return;
+
+    const QByteArray body = it->buffer.mid(headerEnd + 4, contentLength);
+    it->buffer.remove(0, requestSize);
+    it->busy = true;
+
+    handleRequest(socket, requestLine.value(0), requestLine.value(1), body);
+}
+
+void MockDeepSeekServer::handleRequest(QTcpSocket *socket, const QByteArray &method,
+                                       const QByteArray &path, const QByteArray &body)
+{
+    ++m_stats.requests;
+
+    const bool fim = path.endsWith("/beta/completions");
+    if (method != "POST" || !(fim || path.endsWith("/chat/completions"))) {
+        sendResponse(socket, 404, "Not Found", errorJson("Not found", "invalid_request_error"));
+        return;
+    }
+    if (fim)
+        ++m_stats.fim;
+
+    const QJsonObject request = QJsonDocument::fromJson(body).object();
+    const bool stream = request.value("stream").toBool();
+    const Usage usage = promptUsage(request);
+
+    QTimer::singleShot(m_options.latencyMs, socket, [this, socket, stream, usage, fim]() {
+        const double roll = QRandomGenerator::global()->generateDouble();
+        if (roll < m_options.rateLimitRate) {
+            ++m_stats.rateLimited;
+            sendResponse(socket, 429, "Too Many Requests",
+                         errorJson("Rate limit reached for requests", "rate_limit_error"),
+                         "Retry-After: " + QByteArray::number(m_options.retryAfterSeconds) + "\r\n");
+            return;
+        }
+        if (roll < m_options.rateLimitRate + m_options.errorRate) {
+            ++m_stats.errors;
+            sendResponse(socket, 500, "Internal Server Error",
+                         errorJson("The server had an error while processing your request",
+                                   "server_error"));
+            return;
+        }
+
+        if (stream)
+            streamResponse(socket, usage, fim);
+        else
+            sendCompletion(socket, usage, fim);
+    });
+}
+
+void MockDeepSeekServer::sendResponse(QTcpSocket *socket, int status, const QByteArray &reason,
+                                      const QByteArray &body, const QByteArray &extraHeaders)
+{
+    socket->write("HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n"
+                  "Content-Type: application/json\r\n"
+                  "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                  "Connection: keep-alive\r\n"
+                  + extraHeaders + "\r\n" + body);
+    responseDone(socket);
+}
+
+void MockDeepSeekServer::sendCompletion(QTcpSocket *socket, const Usage &usage, bool fim)
+{
+    // Sin streaming la respuesta llega cuando se habría generado el último token
+    const int generationMs = m_options.tokensPerSecond > 0
+                                 ? int(m_options.tokensPerResponse * 1000 / m_options.tokensPerSecond)
+                                 : 0;
+
+    QTimer::singleShot(generationMs, socket, [this, socket, usage, fim]() {
+        QByteArray content;
+        for (int i = 0; i < m_options.tokensPerResponse; ++i)
+            content += tokenText(i);
+
+        const QByteArray choice = fim
+            ? "\"text\":\"" + content + '"'
+            : "\"message\":{\"role\":\"assistant\",\"content\":\"" + content + "\"}";
+        sendResponse(socket, 200, "OK",
+                     "{\"id\":\"mock-" + QByteArray::number(m_stats.requests)
+                         + "\",\"object\":\"" + (fim ? "text_completion" : "chat.completion")
+                         + "\",\"created\":"
+                         + QByteArray::number(QDateTime::currentSecsSinceEpoch())
+                         + ",\"model\":\"deepseek-chat\",\"choices\":[{\"index\":0,"
+                         + choice + ",\"finish_reason\":\"stop\"}],\"usage\":"
+                         + usageJson(usage) + "}");
+    });
+}
+
+void MockDeepSeekServer::streamResponse(QTcpSocket *socket, const Usage &usage, bool fim)
+{
+    ++m_stats.streamed;
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Transfer-Encoding: chunked\r\n"
+                  "Connection: keep-alive\r\n\r\n");
+
+    // Con velocidades altas se envían varios tokens por tick
+    int intervalMs = 0;
+    int tokensPerTick = m_options.tokensPerResponse;
+    if (m_options.tokensPerSecond > 0) {
+        intervalMs = qMax(1, int(1000 / m_options.tokensPerSecond));
+        tokensPerTick = qMax(1, qRound(m_options.tokensPerSecond * intervalMs / 1000));
+    }
+
+    auto *timer = new QTimer(socket);
+    timer->setInterval(intervalMs);
+    const auto sent = std::make_shared<int>(0);
+
+    // FIM: los fragmentos llevan el texto en choices[0].text, sin delta
+    const QByteArray object = fim ? "text_completion" : "chat.completion.chunk";
+    const QByteArray open = fim ? "\"text\":\"" : "\"delta\":{\"content\":\"";
+    const QByteArray close = fim ? "\"" : "\"}";
+    const QByteArray empty = fim ? "\"text\":\"\"" : "\"delta\":{}";
+
+    auto tick = [=, this]() {
+        QByteArray events;
+        for (int i = 0; i < tokensPerTick && *sent < m_options.tokensPerResponse; ++i, ++*sent) {
+            events += "data: {\"id\":\"mock\",\"object\":\"" + object + "\","
+                      "\"model\":\"deepseek-chat\",\"choices\":[{\"index\":0," + open
+                      + tokenText(*sent) + close + ",\"finish_reason\":null}]}\n\n";
+        }
+
+        if (*sent >= m_options.tokensPerResponse) {
+            events += "data: {\"id\":\"mock\",\"object\":\"" + object + "\","
+                      "\"model\":\"deepseek-chat\",\"choices\":[{\"index\":0," + empty
+                      + ",\"finish_reason\":\"stop\"}],\"usage\":" + usageJson(usage) + "}\n\n"
+                      "data: [DONE]\n\n";
+            writeChunk(socket, events);
+            socket->write("0\r\n\r\n");
+            timer->stop();
+            timer->deleteLater();
+            responseDone(socket);
+            return;
+        }
+
+        writeChunk(socket, events);
+    };
+
+    connect(timer, &QTimer::timeout, socket, tick);
+    tick();
+    if (*sent < m_options.tokensPerResponse)
+        timer->start();
+}
+
+void MockDeepSeekServer::responseDone(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end())
+        return;
+
+    it->busy = false;
+    // Petición siguiente ya recibida por la misma conexión
+    if (!it->buffer.isEmpty())
+        QTimer::singleShot(0, socket, [this, socket]() { processBuffer(socket); });
+}
+
+QByteArray MockDeepSeekServer::tokenText(int index)
+{
+    static const char *const words[] = {"void ", "Deep", "Seek", "::", "request", "(", ");\\n",
+                                        "    ", "return ", "content", "; ", "// ", "código "};
+    return words[index % int(std::size(words))];
+}
+
+MockDeepSeekServer::Usage MockDeepSeekServer::promptUsage(const QJsonObject &request)
+{
+    // Texto de los mensajes en orden, como lo vería la caché del servidor;
+    // en FIM, el prompt y el suffix
+    QByteArray prompt = request.value("prompt").toString().toUtf8();
+    if (request.contains("suffix"))
+        prompt += '\n' + request.value("suffix").toString().toUtf8();
+    const QJsonArray messages = request.value("messages").toArray();
+    for (const QJsonValue &message : messages) {
+        prompt += message.toObject().value("role").toString().toUtf8() + '\n';
+        prompt += message.toObject().value("content").toString().toUtf8() + '\n';
+    }
+
+    qsizetype shared = 0;
+    for (const QByteArray &recent : std::as_const(m_recentPrompts)) {
+        const qsizetype length = qMin(recent.size(), prompt.size());
+        qsizetype i = 0;
+        while (i < length && recent.at(i) == prompt.at(i))
+            ++i;
+        shared = qMax(shared, i);
+    }
+
+    // ~4 bytes por token; la caché trabaja en bloques de 64 tokens
+    Usage usage;
+    usage.promptTokens = qMax<qint64>(1, prompt.size() / 4);
+    usage.cacheHitTokens = qMin(usage.promptTokens, qint64(shared / 4) / 64 * 64);
+    m_stats.promptCacheHitTokens += quint64(usage.cacheHitTokens);
+    m_stats.promptCacheMissTokens += quint64(usage.promptTokens - usage.cacheHitTokens);
+
+    m_recentPrompts.append(prompt);
+    if (m_recentPrompts.size() > 32)
+        m_recentPrompts.removeFirst();
+    return usage;
+}
+
+QByteArray MockDeepSeekServer::usageJson(const Usage &usage) const
+{
+    const int completion = m_options.tokensPerResponse;
+    return "{\"prompt_tokens\":" + QByteArray::number(usage.promptTokens)
+           + ",\"completion_tokens\":" + QByteArray::number(completion)
+           + ",\"total_tokens\":" + QByteArray::number(usage.promptTokens + completion)
+           + ",\"prompt_cache_hit_tokens\":" + QByteArray::number(usage.cacheHitTokens)
+           + ",\"prompt_cache_miss_tokens\":"
+           + QByteArray::number(usage.promptTokens - usage.cacheHitTokens) + "}";
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QTcpServer>
+
+class QJsonObject;
+class QTcpSocket;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Sustituto local de la API para medir el camino de peticiones sin red ni
+// API Key. Atiende POST /v1/chat/completions y /beta/completions
+// (fill-in-the-middle) sobre HTTP/1.1 con keep-alive, con o sin streaming
+// SSE, y permite simular latencia, velocidad de generación, errores 500 y
+// 429 con Retry-After. El usage imita la caché de contexto de DeepSeek: los
+// tokens del prefijo compartido con un prompt reciente, en bloques de 64,
+// cuentan como prompt_cache_hit_tokens.
+class MockDeepSeekServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int latencyMs = 50;            // hasta las cabeceras de la respuesta
+        double tokensPerSecond = 200;  // <= 0: todo el contenido de golpe
+        int tokensPerResponse = 100;
+        double errorRate = 0.0;        // fracción de respuestas 500
+        double rateLimitRate = 0.0;    // fracción de respuestas 429
+        int retryAfterSeconds = 1;
+    };
+
+    struct Stats {
+        quint64 requests = 0;
+        quint64 streamed = 0;
+        quint64 fim = 0;
+        quint64 errors = 0;
+        quint64 rateLimited = 0;
+        quint64 promptCacheHitTokens = 0;
+        quint64 promptCacheMissTokens = 0;
+    };
+
+    explicit MockDeepSeekServer(const Options &options, QObject *parent = nullptr);
+
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 0);
+    quint16 port() const { return m_server.serverPort(); }
+    QString errorString() const { return m_server.errorString(); }
+    Stats stats() const { return m_stats; }
+
+private:
+    struct Usage {
+        qint64 promptTokens = 0;
+        qint64 cacheHitTokens = 0;
+    };
+
+    struct Connection {
+        QByteArray buffer;
+        bool busy = false;   // respuesta en curso; las siguientes peticiones esperan
+    };
+
+    void onNewConnection();
+    void processBuffer(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QByteArray &method, const QByteArray &path,
+                       const QByteArray &body);
+    void sendResponse(QTcpSocket *socket, int status, const QByteArray &reason,
+                      const QByteArray &body, const QByteArray &extraHeaders = {});
+    // fim: respuesta de /beta/completions (choices[0].text)
+    void streamResponse(QTcpSocket *socket, const Usage &usage, bool fim);
+    void sendCompletion(QTcpSocket *socket, const Usage &usage, bool fim);
+    void responseDone(QTcpSocket *socket);
+
+    static QByteArray tokenText(int index);
+    Usage promptUsage(const QJsonObject &request);
+    QByteArray usageJson(const Usage &usage) const;
+
+    Options m_options;
+    QTcpServer m_server;
+    QHash<QTcpSocket *, Connection> m_connections;
+    Stats m_stats;
+    QList<QByteArray> m_recentPrompts;   // para simular la caché de contexto
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,50 @@
+// Servidor local que imita /v1/chat/completions. Para usarlo desde el
+// plugin, apuntar DeepSeekPlugin/BaseUrl a http://127.0.0.1:<puerto>/v1.
+
+#include "mockdeepseekserver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("deepseek_mockserver");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local stand-in for the DeepSeek chat completions API");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "Port to listen on.", "port", "8089"},
+        {"latency", "Milliseconds before the response headers.", "ms", "50"},
+        {"tokens-per-second", "Generation speed (0 = send everything at once).", "rate", "200"},
+        {"tokens", "Tokens per response.", "count", "100"},
+        {"error-rate", "Fraction of requests answered with 500.", "fraction", "0"},
+        {"rate-limit-rate", "Fraction of requests answered with 429.", "fraction", "0"},
+        {"retry-after", "Retry-After seconds sent with 429.", "seconds", "1"},
+    });
+    parser.process(app);
+
+    MockDeepSeekServer::Options options;
+    options.latencyMs = parser.value("latency").toInt();
+    options.tokensPerSecond = parser.value("tokens-per-second").toDouble();
+    options.tokensPerResponse = parser.value("tokens").toInt();
+    options.errorRate = parser.value("error-rate").toDouble();
+    options.rateLimitRate = parser.value("rate-limit-rate").toDouble();
+    options.retryAfterSeconds = parser.value("retry-after").toInt();
+
+    MockDeepSeekServer server(options);
+    QTextStream out(stdout);
+    if (!server.listen(QHostAddress::LocalHost, quint16(parser.value("port").toUInt()))) {
+        out << "cannot listen: " << server.errorString() << "\n";
+        return 1;
+    }
+
+    out << "listening on http://127.0.0.1:" << server.port() << "/v1\n";
+    out.flush();
+    return app.exec();
+}
@@ -0,0 +1,98 @@
+// Compara DeepSeekPayloadWriter con el camino anterior basado en
+// QJsonObject + QJsonDocument::toJson() para prompts de distintos tamaños.
+
+#include "deepseekpayloadwriter.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+QString makePrompt(qsizetype size)
+{
+    // Código C++ con comillas, barras, tabuladores y algo de texto no ASCII
+    static const QString sample = QStringLiteral(
+        "void DeepSeekTool::sendRequest(const QString &prompt)\n{\n"
+        "\tqDebug() << \"Petición: \" << prompt; // corrección \\ análisis\n"
+        "\tconst char *path = \"C:\\\\temp\\\\файл.txt\";\n}\n\n");
+
+    QString prompt;
+    prompt.reserve(size + sample.size());
+    while (prompt.size() < size)
+        prompt += sample;
+    prompt.truncate(size);
+    return prompt;
+}
+
+QByteArray writeWithDom(const QString &prompt)
+{
+    QJsonObject json;
+    json["model"] = "deepseek-chat";
+    json["messages"] = QJsonArray({
+        QJsonObject({{"role", "system"}, {"content", "Eres un asistente de corrección de código."}}),
+        QJsonObject({{"role", "user"}, {"content", prompt}})
+    });
+    json["temperature"] = 0.7;
+    json["max_tokens"] = 2000;
+    json["stream"] = true;
+    return QJsonDocument(json).toJson();
+}
+
+QByteArray writeWithWriter(const QString &prompt)
+{
+    ChatCompletionRequest chat;
+    chat.messages.append({"system", "Eres un asistente de corrección de código."});
+    chat.messages.append({"user", prompt});
+    chat.stream = true;
+    return DeepSeekPayloadWriter::write(chat);
+}
+
+template<typename Fn>
+double averageMs(int iterations, Fn fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return double(timer.nsecsElapsed()) / 1e6 / iterations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QList<qsizetype> sizes = {1024, 100 * 1024, 1024 * 1024, 5 * 1024 * 1024};
+    out << "prompt chars | QJsonDocument ms | writer ms | speedup | output bytes (dom / writer)\n";
+
+    for (qsizetype size : sizes) {
+        const QString prompt = makePrompt(size);
+        const int iterations = size > 1024 * 1024 ? 5 : (size > 100 * 1024 ? 20 : 500);
+
+        const QByteArray dom = writeWithDom(prompt);
+        const QByteArray written = writeWithWriter(prompt);
+        if (QJsonDocument::fromJson(written).object() != QJsonDocument::fromJson(dom).object()) {
+            out << "payload mismatch at " << size << " chars\n";
+            return 1;
+        }
+
+        const double domMs = averageMs(iterations, [&] { writeWithDom(prompt); });
+        const double writerMs = averageMs(iterations, [&] { writeWithWriter(prompt); });
+
+        out << qSetFieldWidth(12) << size << qSetFieldWidth(0) << " | "
+            << QString::number(domMs, 'f', 3) << " | "
+            << QString::number(writerMs, 'f', 3) << " | "
+            << QString::number(domMs / writerMs, 'f', 1) << "x | "
+            << dom.size() << " / " << written.size() << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Compara la memoria de un proyecto cargado como QMap<QString, QString> (el
+// formato anterior) y como DeepSeekProjectSnapshot. Cada variante se mide
+// en un proceso propio para que el pico de RSS de una no tape a la otra.
+//
+//   deepseek_projectsnapshot_bench [files]          ambas variantes
+//   deepseek_projectsnapshot_bench map|snapshot [files]
+
+#include "deepseekprojectsnapshot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+qint64 peakRssKb()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(Q_OS_MACOS)
+    return qint64(usage.ru_maxrss / 1024); // bytes en macOS
+#else
+    return qint64(usage.ru_maxrss);        // KB en Linux
+#endif
+#endif
+}
+
+// Ruta de monorepo: directorios profundos y compartidos por muchos ficheros
+QString makePath(int i)
+{
+    return QString("/home/developer/work/monorepo/components/module%1/src/detail%2/"
+                   "implementation_file_%3.cpp")
+        .arg(i / 500).arg((i / 50) % 10).arg(i);
+}
+
+QByteArray makeContent(QRandomGenerator &random)
+{
+    // Tamaños de fichero típicos: la mayoría pequeños, algunos grandes
+    const double r = random.generateDouble();
+    const int size = 512 + int(r * r * r * 32 * 1024);
+    QByteArray content(size, 'x');
+    for (int i = 63; i < size; i += 64)
+        content[i] = '\n';
+    return content;
+}
+
+int run(const QString &mode, int files)
+{
+    QTextStream out(stdout);
+    QRandomGenerator random(3);
+    const qint64 baseKb = peakRssKb();
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 bytes = 0;
+    qsizetype checksum = 0;
+
+    if (mode == "map") {
+        QMap<QString, QString> contents;
+        for (int i = 0; i < files; ++i) {
+            const QByteArray content = makeContent(random);
+            bytes += content.size();
+            contents.insert(makePath(i), QString::fromUtf8(content));
+        }
+        // Copia implícita al pasar por una señal encolada: comparte datos
+        const QMap<QString, QString> queued = contents;
+        for (const auto &[path, content] : queued.asKeyValueRange())
+            checksum += path.size() + content.size();
+    } else {
+        DeepSeekProjectSnapshot::Builder builder;
+        builder.reserve(files, 0);
+        for (int i = 0; i < files; ++i) {
+            const QByteArray content = makeContent(random);
+            bytes += content.size();
+            builder.addFile(makePath(i), content);
+        }
+        const DeepSeekProjectSnapshot::Pointer snapshot = builder.build();
+        for (int i = 0; i < snapshot->fileCount(); ++i)
+            checksum += snapshot->path(i).size() + snapshot->content(i).size();
+        if (snapshot->indexOf(makePath(files / 2)) < 0) {
+            out << "indexOf failed\n";
+            return 1;
+        }
+    }
+
+    out << qSetFieldWidth(9) << mode << qSetFieldWidth(0) << " | " << files << " files | "
+        << bytes / (1024 * 1024) << " MB | " << timer.elapsed() << " ms | "
+        << "peak RSS +" << (peakRssKb() - baseKb) / 1024 << " MB"
+        << (checksum > 0 ? "" : " (empty)") << "\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    if (args.size() > 1 && (args.at(1) == "map" || args.at(1) == "snapshot"))
+        return run(args.at(1), args.size() > 2 ? args.at(2).toInt() : 100000);
+
+    const QString files = args.size() > 1 ? args.at(1) : QString("100000");
+    for (const QString mode : {QString("map"), QString("snapshot")}) {
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedChannels);
+        process.start(app.applicationFilePath(), {mode, files});
+        if (!process.waitForFinished(-1) || process.exitCode() != 0)
+            return 1;
+    }
+    return 0;
+}
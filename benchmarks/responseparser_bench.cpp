@@ -0,0 +1,151 @@
+// Compara DeepSeekResponseParser con el camino anterior basado en
+// QJsonDocument para respuestas de 1 KB, 100 KB y 1 MB, y mide también el
+// coste por evento de un stream SSE.
+
+#include "deepseekresponseparser.h"
+#include "deepseekpayloadwriter.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+QString makeContent(qsizetype size)
+{
+    static const QString sample = QStringLiteral(
+        "```cpp\nvoid DeepSeekTool::sendRequest(const QString &prompt)\n{\n"
+        "\tqDebug() << \"Petición: \" << prompt; // corrección \\ análisis 🚀\n}\n```\n\n");
+
+    QString content;
+    content.reserve(size + sample.size());
+    while (content.size() < size)
+        content += sample;
+    content.truncate(size);
+    return content;
+}
+
+QByteArray jsonString(const QString &text)
+{
+    QByteArray out(DeepSeekPayloadWriter::jsonStringSize(text), Qt::Uninitialized);
+    DeepSeekPayloadWriter::writeJsonString(out.data(), text);
+    return out;
+}
+
+QByteArray makeResponse(const QString &content)
+{
+    return "{\"id\":\"930c60df-bf64-41c9-a88e-3ec75f81e00e\",\"object\":\"chat.completion\","
+           "\"created\":1705651092,\"model\":\"deepseek-chat\",\"choices\":[{\"index\":0,"
+           "\"message\":{\"role\":\"assistant\",\"content\":"
+           + jsonString(content)
+           + "},\"logprobs\":null,\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":16,"
+             "\"completion_tokens\":10,\"total_tokens\":26,\"prompt_cache_hit_tokens\":0,"
+             "\"prompt_cache_miss_tokens\":16},\"system_fingerprint\":\"fp_44709d6fcb\"}";
+}
+
+QByteArray makeStreamEvent(const QString &delta)
+{
+    return "{\"id\":\"930c60df-bf64-41c9-a88e-3ec75f81e00e\",\"object\":\"chat.completion.chunk\","
+           "\"created\":1705651092,\"model\":\"deepseek-chat\",\"system_fingerprint\":\"fp_44709d6fcb\","
+           "\"choices\":[{\"index\":0,\"delta\":{\"content\":"
+           + jsonString(delta) + "},\"logprobs\":null,\"finish_reason\":null}]}";
+}
+
+// Lo que hacía DeepSeekRequest antes del parser propio
+ChatCompletionResult parseWithDom(const QByteArray &body)
+{
+    ChatCompletionResult result;
+    const QJsonObject obj = QJsonDocument::fromJson(body).object();
+    const QJsonObject choice = obj.value("choices").toArray().first().toObject();
+    result.hasChoices = obj.contains("choices");
+    result.content = choice.contains("message")
+                         ? choice.value("message").toObject().value("content").toString()
+                         : choice.value("delta").toObject().value("content").toString();
+    result.finishReason = choice.value("finish_reason").toString();
+    const QJsonObject usage = obj.value("usage").toObject();
+    result.usage.promptTokens = usage.value("prompt_tokens").toInteger(-1);
+    result.usage.completionTokens = usage.value("completion_tokens").toInteger(-1);
+    result.usage.totalTokens = usage.value("total_tokens").toInteger(-1);
+    return result;
+}
+
+ChatCompletionResult parseWithScanner(const QByteArray &body)
+{
+    ChatCompletionResult result;
+    DeepSeekResponseParser::parse(body, &result);
+    return result;
+}
+
+template<typename Fn>
+double averageUs(int iterations, Fn fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return double(timer.nsecsElapsed()) / 1e3 / iterations;
+}
+
+bool sameResult(const ChatCompletionResult &a, const ChatCompletionResult &b)
+{
+    return a.content == b.content && a.finishReason == b.finishReason
+           && a.usage.promptTokens == b.usage.promptTokens
+           && a.usage.completionTokens == b.usage.completionTokens
+           && a.usage.totalTokens == b.usage.totalTokens;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    out << "response bytes | QJsonDocument us | parser us | speedup\n";
+
+    const QList<qsizetype> sizes = {1024, 100 * 1024, 1024 * 1024};
+    for (qsizetype size : sizes) {
+        // El contenido se ajusta para que la respuesta completa ronde el tamaño pedido
+        const QByteArray body = makeResponse(makeContent(qMax<qsizetype>(64, size - 400)));
+        const int iterations = size >= 1024 * 1024 ? 20 : (size >= 100 * 1024 ? 200 : 20000);
+
+        ChatCompletionResult scanned;
+        if (DeepSeekResponseParser::parse(body, &scanned) != DeepSeekResponseParser::Complete
+            || !sameResult(scanned, parseWithDom(body))) {
+            out << "result mismatch at " << body.size() << " bytes\n";
+            return 1;
+        }
+
+        const double domUs = averageUs(iterations, [&] { parseWithDom(body); });
+        const double scanUs = averageUs(iterations, [&] { parseWithScanner(body); });
+
+        out << qSetFieldWidth(14) << body.size() << qSetFieldWidth(0) << " | "
+            << QString::number(domUs, 'f', 2) << " | "
+            << QString::number(scanUs, 'f', 2) << " | "
+            << QString::number(domUs / scanUs, 'f', 1) << "x\n";
+    }
+
+    // Un stream típico: muchos eventos pequeños con unos pocos caracteres cada uno
+    const QByteArray event = makeStreamEvent(QStringLiteral("código "));
+    ChatCompletionResult scanned;
+    DeepSeekResponseParser::parse(event, &scanned);
+    if (!sameResult(scanned, parseWithDom(event))) {
+        out << "stream event mismatch\n";
+        return 1;
+    }
+
+    const int events = 100000;
+    const double domUs = averageUs(events, [&] { parseWithDom(event); });
+    const double scanUs = averageUs(events, [&] { parseWithScanner(event); });
+    out << "stream event (" << event.size() << " bytes) | "
+        << QString::number(domUs, 'f', 2) << " | "
+        << QString::number(scanUs, 'f', 2) << " | "
+        << QString::number(domUs / scanUs, 'f', 1) << "x\n";
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Mide DeepSeekSearchIndex sobre un proyecto sintético (100k ficheros por
+// defecto); el objetivo es responder una consulta en menos de 10 ms y
+// actualizar unos pocos ficheros en mucho menos que una construcción.
+
+#include "deepseeksearchindex.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include <algorithm>
+#include <memory>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+// Vocabulario con la distribución típica de un proyecto: pocas palabras muy
+// frecuentes y una cola larga de identificadores propios
+QList<QByteArray> makeVocabulary(int size)
+{
+    static const char *const common[] = {"QString", "QList", "m_data", "value", "size",
+                                         "append", "connect", "result", "index", "count"};
+    static const char *const parts[] = {"request", "cache", "token", "chunk", "project",
+                                        "parser", "stream", "editor", "widget", "scheduler",
+                                        "index", "file", "reply", "payload", "session"};
+
+    QList<QByteArray> words;
+    for (const char *word : common)
+        words.append(word);
+    QRandomGenerator random(1);
+    while (words.size() < size) {
+        QByteArray word = parts[random.bounded(int(std::size(parts)))];
+        QByteArray second = parts[random.bounded(int(std::size(parts)))];
+        second[0] = char(second.at(0) - 'a' + 'A');
+        words.append(word + second + QByteArray::number(words.size()));
+    }
+    return words;
+}
+
+QByteArray makeFile(const QList<QByteArray> &words, QRandomGenerator &random)
+{
+    QByteArray content;
+    const int lines = 40 + random.bounded(160);
+    for (int line = 0; line < lines; ++line) {
+        content += "    ";
+        const int tokens = 3 + random.bounded(6);
+        for (int i = 0; i < tokens; ++i) {
+            // Zipf aproximado: el cubo favorece los primeros índices
+            const double r = random.generateDouble();
+            content += words.at(int(r * r * r * words.size()));
+            content += i + 1 < tokens ? "->" : ";\n";
+        }
+    }
+    return content;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int files = argc > 1 ? QByteArray(argv[1]).toInt() : 100000;
+    const QList<QByteArray> words = makeVocabulary(50000);
+    QRandomGenerator random(2);
+
+    QElapsedTimer timer;
+    timer.start();
+    DeepSeekProjectSnapshot::Builder builder;
+    for (int i = 0; i < files; ++i)
+        builder.addFile(QString("src/module%1/file%2.cpp").arg(i / 100).arg(i), makeFile(words, random));
+    const qint64 bytes = builder.bytes();
+    auto index = std::make_shared<DeepSeekSearchIndex>();
+    index->build(builder.build());
+    const qint64 buildMs = timer.elapsed();
+
+    out << files << " files, " << bytes / (1024 * 1024) << " MB, " << index->documentCount()
+        << " documents, " << index->termCount() << " terms, built in " << buildMs << " ms\n";
+
+    // Consultas cortas (modo code) y largas (modo fix: un fichero entero)
+    for (const bool longQuery : {false, true}) {
+        QList<qint64> times;
+        int hits = 0;
+        for (int q = 0; q < 200; ++q) {
+            QString query;
+            if (longQuery) {
+                query = QString::fromUtf8(makeFile(words, random));
+            } else {
+                query = "Fix the crash in ";
+                for (int i = 0; i < 4; ++i)
+                    query += QString::fromUtf8(words.at(random.bounded(int(words.size())))) + ' ';
+            }
+
+            timer.start();
+            hits += int(index->search(query, 12).size());
+            times.append(timer.nsecsElapsed() / 1000);
+        }
+        std::sort(times.begin(), times.end());
+        out << (longQuery ? "long query " : "short query") << "  p50 "
+            << QString::number(times.at(99) / 1000.0, 'f', 2) << " ms  p99 "
+            << QString::number(times.at(197) / 1000.0, 'f', 2) << " ms  ("
+            << hits / 200 << " hits/query)\n";
+    }
+
+    // Mantenimiento: unos pocos ficheros guardados y un checkout que toca
+    // el 5% del proyecto, frente a reconstruir el índice entero
+    for (const int changed : {10, qMax(1, files / 20)}) {
+        timer.start();
+        DeepSeekProjectSnapshot::Builder changes;
+        for (int i = 0; i < changed; ++i) {
+            const int file = random.bounded(files);
+            changes.addFile(QString("src/module%1/file%2.cpp").arg(file / 100).arg(file),
+                            makeFile(words, random));
+        }
+        const std::shared_ptr<DeepSeekSearchIndex> updated = index->updated(changes.build(), {});
+        const qint64 updateMs = timer.elapsed();
+        out << "update " << changed << " files in " << updateMs << " ms ("
+            << updated->documentCount() << " live documents, compaction "
+            << (updated->needsCompaction() ? "needed" : "not needed") << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Mide la aplicación de una corrección a un QTextDocument de 1k a 50k
+// líneas: reemplazar el documento entero frente a DeepSeekTextDiff (cálculo
+// del diff y aplicación de sus ediciones en un solo bloque de deshacer).
+// Comprueba además que las ediciones reproducen el texto corregido.
+
+#include "deepseektextdiff.h"
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QRandomGenerator>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+QStringList makeLines(int count)
+{
+    QStringList lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        switch (i % 8) {
+        case 0: lines.append(QString("void Request%1::update(int value)").arg(i)); break;
+        case 1: lines.append("{"); break;
+        case 2: lines.append(QString("    m_value%1 = value * %2;").arg(i).arg(i % 7)); break;
+        case 3: lines.append(QString("    if (m_value%1 > limit())").arg(i - 1)); break;
+        case 4: lines.append("        emit changed();"); break;
+        case 5: lines.append("}"); break;
+        default: lines.append(QString()); break;
+        }
+    }
+    return lines;
+}
+
+// Lo típico de una corrección: unas pocas líneas cambiadas, añadidas y quitadas
+QStringList applyFix(QStringList lines, QRandomGenerator &random)
+{
+    for (int i = 0; i < 6; ++i) {
+        const int line = random.bounded(int(lines.size()));
+        lines[line] += " // fixed";
+    }
+    for (int i = 0; i < 3; ++i)
+        lines.insert(random.bounded(int(lines.size())), "    Q_ASSERT(value >= 0);");
+    for (int i = 0; i < 2; ++i)
+        lines.removeAt(random.bounded(int(lines.size())));
+    return lines;
+}
+
+struct Measure {
+    qint64 elapsedUs = 0;
+    qint64 charsChanged = 0;
+};
+
+template<typename Apply>
+Measure measure(const QString &original, Apply apply)
+{
+    QTextDocument document;
+    document.setPlainText(original);
+    document.documentLayout();   // con maquetación, como en el editor
+
+    Measure result;
+    QObject::connect(&document, &QTextDocument::contentsChange,
+                     [&result](int, int removed, int added) {
+                         result.charsChanged += removed + added;
+                     });
+    QElapsedTimer timer;
+    timer.start();
+    apply(document);
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+    QRandomGenerator random(3);
+
+    out << "lines     full replace           diff (compute + apply)    chars changed (full / diff)\n";
+    for (const int count : {1000, 10000, 50000}) {
+        const QStringList lines = makeLines(count);
+        const QString original = lines.join('\n') + '\n';
+        const QString fixed = applyFix(lines, random).join('\n') + '\n';
+
+        const Measure full = measure(original, [&fixed](QTextDocument &document) {
+            QTextCursor cursor(&document);
+            cursor.select(QTextCursor::Document);
+            cursor.insertText(fixed);
+        });
+
+        qint64 computeUs = 0;
+        bool ok = true;
+        const Measure diff = measure(original, [&](QTextDocument &document) {
+            QElapsedTimer timer;
+            timer.start();
+            const QList<DeepSeekTextDiff::Edit> edits = DeepSeekTextDiff::compute(original, fixed);
+            computeUs = timer.nsecsElapsed() / 1000;
+            ok = DeepSeekTextDiff::apply(original, edits) == fixed;
+
+            QTextCursor cursor(&document);
+            cursor.beginEditBlock();
+            for (auto it = edits.crbegin(); it != edits.crend(); ++it) {
+                cursor.setPosition(it->position);
+                cursor.setPosition(it->position + it->length, QTextCursor::KeepAnchor);
+                cursor.insertText(it->text);
+            }
+            cursor.endEditBlock();
+            ok = ok && document.toPlainText() == fixed;
+        });
+
+        out << QString("%1  %2 ms  %3 ms (%4 + %5)  %6 / %7%8\n")
+                   .arg(count, 5)
+                   .arg(full.elapsedUs / 1000.0, 12, 'f', 2)
+                   .arg(diff.elapsedUs / 1000.0, 12, 'f', 2)
+                   .arg(computeUs / 1000.0, 0, 'f', 2)
+                   .arg((diff.elapsedUs - computeUs) / 1000.0, 0, 'f', 2)
+                   .arg(full.charsChanged)
+                   .arg(diff.charsChanged)
+                   .arg(ok ? QString() : QString("  MISMATCH"));
+        out.flush();
+        if (!ok)
+            return 1;
+    }
+    return 0;
+}
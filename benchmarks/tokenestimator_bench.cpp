@@ -0,0 +1,67 @@
+// Mide DeepSeekTokenEstimator sobre código fuente de 1 KB a 5 MB; el objetivo
+// es estimar un proyecto de 5 MB muy por debajo de 100 ms.
+
+#include "deepseektokenestimator.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+using namespace DeepSeekAI::Internal;
+
+namespace {
+
+QString makeSource(qsizetype size)
+{
+    static const QString sample = QStringLiteral(
+        "void DeepSeekTool::sendRequest(const QString &prompt, const QString &mode)\n{\n"
+        "    // Cuerpo de la petición según el modo\n"
+        "    ChatCompletionRequest chat;\n"
+        "    chat.messages.append({\"user\", prompt});\n"
+        "    chat.maxTokens = 2000; // límite 0x7FFF, análisis 🚀\n"
+        "    return submitRequest(chat, mode);\n}\n\n");
+
+    QString source;
+    source.reserve(size + sample.size());
+    while (source.size() < size)
+        source += sample;
+    source.truncate(size);
+    return source;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    out << "source chars | tokens | chars/token | ms | MB/s\n";
+
+    const QList<qsizetype> sizes = {1024, 100 * 1024, 1024 * 1024, 5 * 1024 * 1024};
+    for (qsizetype size : sizes) {
+        const QString source = makeSource(size);
+        const int iterations = size >= 1024 * 1024 ? 10 : (size >= 100 * 1024 ? 200 : 20000);
+
+        int tokens = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+            tokens = DeepSeekTokenEstimator::estimate(source);
+        const double ms = double(timer.nsecsElapsed()) / 1e6 / iterations;
+
+        const qsizetype cut = DeepSeekTokenEstimator::truncatedLength(source, tokens / 2);
+        if (DeepSeekTokenEstimator::estimate(QStringView(source).left(cut)) > tokens / 2) {
+            out << "truncatedLength overflows the budget at " << size << " chars\n";
+            return 1;
+        }
+
+        out << qSetFieldWidth(12) << size << qSetFieldWidth(0) << " | "
+            << tokens << " | "
+            << QString::number(double(size) / tokens, 'f', 2) << " | "
+            << QString::number(ms, 'f', 3) << " | "
+            << QString::number(double(size) * 2 / 1e6 / (ms / 1000), 'f', 0) << "\n";
+    }
+
+    return 0;
+}
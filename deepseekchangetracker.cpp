@@ -0,0 +1,81 @@
+#include "deepseekchangetracker.h"
+
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+DeepSeekChangeTracker::DeepSeekChangeTracker(QTextDocument *document, QObject *parent)
+    : QObject(parent),
+      m_document(document)
+{
+    m_publishedLength = currentLength();
+    m_publishedRevision = document->revision();
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &DeepSeekChangeTracker::flush);
+    connect(document, &QTextDocument::contentsChange,
+            this, &DeepSeekChangeTracker::onContentsChange);
+}
+
+int DeepSeekChangeTracker::currentLength() const
+{
+    // Sin el separador de párrafo final, que no forma parte de plainText()
+    return m_document ? m_document->characterCount() - 1 : 0;
+}
+
+void DeepSeekChangeTracker::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // QTextDocument puede contar el separador final; el rango no pasa del texto
+    const int length = currentLength();
+    const int lengthBefore = length - charsAdded + charsRemoved;
+    const int removedEnd = qMin(position + charsRemoved, qMax(lengthBefore, position));
+
+    if (!m_dirty) {
+        m_dirty = true;
+        m_start = position;
+        m_end = removedEnd;
+    } else {
+        // Fin del rango sucio en el texto de antes de este cambio
+        const int dirtyEnd = m_end + (lengthBefore - m_publishedLength);
+        int publishedEnd = removedEnd;
+        if (removedEnd > m_start)
+            publishedEnd = removedEnd >= dirtyEnd ? removedEnd - dirtyEnd + m_end : m_end;
+        m_start = qMin(m_start, position);
+        m_end = qMax(m_end, publishedEnd);
+    }
+    m_start = qBound(0, m_start, m_publishedLength);
+    m_end = qBound(m_start, m_end, m_publishedLength);
+
+    m_debounce.start();
+}
+
+void DeepSeekChangeTracker::flush()
+{
+    m_debounce.stop();
+    if (!m_dirty || !m_document)
+        return;
+
+    const int length = currentLength();
+    Delta delta;
+    delta.revision = m_document->revision();
+    delta.position = m_start;
+    delta.removedLength = m_end - m_start;
+    const int newEnd = m_end + (length - m_publishedLength);
+    if (newEnd > m_start) {
+        QTextCursor cursor(m_document);
+        cursor.setPosition(m_start);
+        cursor.setPosition(newEnd, QTextCursor::KeepAnchor);
+        delta.text = cursor.selection().toPlainText();
+    }
+
+    m_dirty = false;
+    m_publishedLength = length;
+    m_publishedRevision = delta.revision;
+    emit changed(delta);
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
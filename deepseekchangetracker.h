@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QMetaType>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+class QTextDocument;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Sigue los cambios de un QTextDocument y los publica agrupados.
+//
+// Cada contentsChange() amplía un único rango sucio, expresado en el texto
+// de la última publicación; tras DebounceMs sin cambios (o con flush()) se
+// publica como un Delta: qué rango del texto anterior se sustituye y por
+// qué. Aplicando los deltas en orden a una copia del texto se obtiene el
+// documento actual, así que cachés e índices se actualizan en O(edición)
+// sin volver a pedir plainText().
+class DeepSeekChangeTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Delta {
+        int revision = 0;       // QTextDocument::revision() al publicar
+        int position = 0;       // en el texto de la publicación anterior
+        int removedLength = 0;
+        QString text;           // lo que ocupa ahora ese rango
+    };
+
+    static constexpr int DebounceMs = 150;
+
+    explicit DeepSeekChangeTracker(QTextDocument *document, QObject *parent = nullptr);
+
+    QTextDocument *document() const { return m_document; }
+    bool hasPendingChanges() const { return m_dirty; }
+    // Revisión del documento en la última publicación
+    int publishedRevision() const { return m_publishedRevision; }
+
+public slots:
+    // Publica ya lo pendiente (antes de leer el documento por otro camino)
+    void flush();
+
+signals:
+    void changed(const DeepSeekAI::Internal::DeepSeekChangeTracker::Delta &delta);
+
+private:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    int currentLength() const;
+
+    QPointer<QTextDocument> m_document;
+    QTimer m_debounce;
+    int m_publishedLength = 0;
+    int m_publishedRevision = 0;
+    // Rango sucio en el texto publicado: [m_start, m_end)
+    bool m_dirty = false;
+    int m_start = 0;
+    int m_end = 0;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
+
+Q_DECLARE_METATYPE(DeepSeekAI::Internal::DeepSeekChangeTracker::Delta)
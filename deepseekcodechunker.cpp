@@ -0,0 +1,420 @@
+#include "deepseekcodechunker.h"
+#include "deepseektokenestimator.h"
+
+#include <QString>
+
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+using Unit = DeepSeekCodeChunker::Unit;
+
+inline bool isIdent(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+           || c == '_';
+}
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// Posición de word como palabra completa dentro de text, o -1
+qsizetype findWord(QByteArrayView text, QByteArrayView word)
+{
+    qsizetype from = 0;
+    while (true) {
+        const qsizetype at = text.indexOf(word, from);
+        if (at < 0)
+            return -1;
+        const qsizetype after = at + word.size();
+        if ((at == 0 || !isIdent(text.at(at - 1))) && (after == text.size() || !isIdent(text.at(after))))
+            return at;
+        from = at + 1;
+    }
+}
+
+class Scanner
+{
+public:
+    Scanner(QByteArrayView content, DeepSeekCodeChunker::Language language)
+        : m_data(content.data()),
+          m_size(content.size()),
+          m_content(content),
+          m_qml(language == DeepSeekCodeChunker::Qml)
+    {
+    }
+
+    QList<Unit> run();
+
+private:
+    qsizetype skipLineComment(qsizetype i) const;
+    qsizetype skipBlockComment(qsizetype i) const;
+    qsizetype skipString(qsizetype i, char quote) const;
+    qsizetype skipRawString(qsizetype i) const;
+    qsizetype skipPreprocessor(qsizetype i) const;
+    qsizetype restOfLine(qsizetype i) const;
+    bool isRawStringStart(qsizetype i) const;
+
+    bool isTransparent(QByteArrayView header);
+    Unit::Kind classify(QByteArrayView header) const;
+    void endUnit(qsizetype end, Unit::Kind kind);
+    void significant(qsizetype i);
+
+    const char *m_data;
+    const qsizetype m_size;
+    const QByteArrayView m_content;
+    const bool m_qml;
+
+    QList<Unit> m_units;
+    QList<bool> m_braces;       // true: llave transparente (namespace, raíz QML)
+    int m_depth = 0;            // llaves no transparentes abiertas
+    int m_parenDepth = 0;
+    qsizetype m_unitStart = 0;
+    qsizetype m_headerStart = -1;   // primer carácter significativo de la unidad
+    Unit::Kind m_unitKind = Unit::Declarations;
+    bool m_qmlRootSeen = false;
+    bool m_lineHasContent = false;
+};
+
+QList<Unit> Scanner::run()
+{
+    qsizetype i = 0;
+    while (i < m_size) {
+        const char c = m_data[i];
+        const char next = i + 1 < m_size ? m_data[i + 1] : '\0';
+
+        if (isSpace(c)) {
+            if (c == '\n') {
+                m_lineHasContent = false;
+                // En QML una propiedad termina con la línea
+                if (m_qml && m_depth == 0 && m_parenDepth == 0 && m_headerStart >= 0) {
+                    endUnit(i + 1, Unit::Declarations);
+                }
+            }
+            ++i;
+            continue;
+        }
+
+        if (c == '/' && next == '/') {
+            i = skipLineComment(i);
+            continue;
+        }
+        if (c == '/' && next == '*') {
+            i = skipBlockComment(i);
+            continue;
+        }
+
+        if (c == '#' && !m_qml && !m_lineHasContent) {
+            significant(i);
+            i = skipPreprocessor(i);
+            if (m_depth == 0 && m_parenDepth == 0)
+                endUnit(restOfLine(i), Unit::Declarations);
+            continue;
+        }
+
+        significant(i);
+        m_lineHasContent = true;
+
+        switch (c) {
+        case '"':
+            i = isRawStringStart(i) ? skipRawString(i) : skipString(i, '"');
+            continue;
+        case '\'':
+            // Separador de dígitos de C++14 (1'000'000)
+            if (!m_qml && i > 0 && m_data[i - 1] >= '0' && m_data[i - 1] <= '9') {
+                ++i;
+                continue;
+            }
+            i = skipString(i, '\'');
+            continue;
+        case '`':
+            if (m_qml) {
+                i = skipString(i, '`');
+                continue;
+            }
+            break;
+        case '(':
+        case '[':
+            ++m_parenDepth;
+            break;
+        case ')':
+        case ']':
+            m_parenDepth = qMax(0, m_parenDepth - 1);
+            break;
+        case '{':
+            if (m_depth == 0 && m_parenDepth == 0) {
+                const QByteArrayView header = m_content.sliced(m_headerStart, i - m_headerStart);
+                if (isTransparent(header)) {
+                    m_braces.append(true);
+                    ++i;
+                    endUnit(restOfLine(i), Unit::Declarations);
+                    continue;
+                }
+                m_unitKind = classify(header);
+            }
+            m_braces.append(false);
+            ++m_depth;
+            break;
+        case '}':
+            if (m_braces.isEmpty())
+                break;
+            if (m_braces.takeLast()) {
+                // Cierre de namespace o del objeto raíz: va con lo que le precede
+                ++i;
+                endUnit(restOfLine(i), Unit::Declarations);
+                continue;
+            }
+            if (--m_depth == 0 && m_parenDepth == 0) {
+                ++i;
+                endUnit(restOfLine(i), m_unitKind);
+                continue;
+            }
+            break;
+        case ';':
+            if (m_depth == 0 && m_parenDepth == 0) {
+                ++i;
+                endUnit(restOfLine(i), Unit::Declarations);
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        ++i;
+    }
+
+    // Lo que queda: una definición sin cerrar, declaraciones o solo
+    // comentarios y espacios, que se unen a la unidad anterior
+    if (m_unitStart < m_size) {
+        if (m_headerStart >= 0 || m_units.isEmpty())
+            endUnit(m_size, m_depth > 0 ? m_unitKind : Unit::Declarations);
+        else
+            m_units.last().end = m_size;
+    }
+
+    // Declaraciones consecutivas en una sola unidad
+    QList<Unit> merged;
+    merged.reserve(m_units.size());
+    for (const Unit &unit : std::as_const(m_units)) {
+        if (!merged.isEmpty() && unit.kind == Unit::Declarations
+            && merged.last().kind == Unit::Declarations) {
+            merged.last().end = unit.end;
+        } else {
+            merged.append(unit);
+        }
+    }
+    return merged;
+}
+
+void Scanner::significant(qsizetype i)
+{
+    if (m_headerStart < 0) {
+        m_headerStart = i;
+        m_unitKind = Unit::Declarations;
+    }
+}
+
+void Scanner::endUnit(qsizetype end, Unit::Kind kind)
+{
+    if (end <= m_unitStart)
+        return;
+
+    Unit unit;
+    unit.kind = kind;
+    unit.begin = m_unitStart;
+    unit.end = end;
+    m_units.append(unit);
+
+    m_unitStart = end;
+    m_headerStart = -1;
+    m_parenDepth = 0;
+    m_unitKind = Unit::Declarations;
+}
+
+bool Scanner::isTransparent(QByteArrayView header)
+{
+    if (m_qml) {
+        // El objeto raíz envuelve todo el fichero; en un .js no lo hay
+        if (m_qmlRootSeen || classify(header) != Unit::QmlObject)
+            return false;
+        m_qmlRootSeen = true;
+        return true;
+    }
+
+    if (header.contains('(') || header.contains('='))
+        return false;
+    return findWord(header, "namespace") >= 0 || findWord(header, "extern") >= 0;
+}
+
+Unit::Kind Scanner::classify(QByteArrayView header) const
+{
+    const qsizetype paren = header.indexOf('(');
+
+    if (m_qml) {
+        if (findWord(header, "function") >= 0)
+            return Unit::Function;
+        // Rectangle {, Controls.Button { frente a anchors { u onClicked: {
+        qsizetype end = header.size();
+        while (end > 0 && isSpace(header.at(end - 1)))
+            --end;
+        qsizetype start = end;
+        while (start > 0 && isIdent(header.at(start - 1)))
+            --start;
+        if (start < end && header.at(start) >= 'A' && header.at(start) <= 'Z')
+            return Unit::QmlObject;
+        return Unit::Block;
+    }
+
+    for (const char *keyword : {"class", "struct", "union", "enum"}) {
+        const qsizetype at = findWord(header, keyword);
+        if (at >= 0 && (paren < 0 || at < paren))
+            return Unit::Class;
+    }
+    return paren >= 0 ? Unit::Function : Unit::Block;
+}
+
+qsizetype Scanner::skipLineComment(qsizetype i) const
+{
+    const void *newline = std::memchr(m_data + i, '\n', size_t(m_size - i));
+    return newline ? static_cast<const char *>(newline) - m_data : m_size;
+}
+
+qsizetype Scanner::skipBlockComment(qsizetype i) const
+{
+    const qsizetype end = m_content.indexOf("*/", i + 2);
+    return end < 0 ? m_size : end + 2;
+}
+
+qsizetype Scanner::skipString(qsizetype i, char quote) const
+{
+    for (qsizetype j = i + 1; j < m_size; ++j) {
+        const char c = m_data[j];
+        if (c == '\\')
+            ++j;
+        else if (c == quote)
+            return j + 1;
+        else if (c == '\n' && quote != '`')
+            return j;   // literal sin cerrar: no arrastrar el resto del fichero
+    }
+    return m_size;
+}
+
+bool Scanner::isRawStringStart(qsizetype i) const
+{
+    if (m_qml || i == 0 || m_data[i - 1] != 'R')
+        return false;
+    if (i == 1)
+        return true;
+    const char before = m_data[i - 2];
+    // R"...", u8R"...", LR"...", uR"...", UR"..."
+    return !isIdent(before) || before == '8' || before == 'u' || before == 'U' || before == 'L';
+}
+
+qsizetype Scanner::skipRawString(qsizetype i) const
+{
+    // R"delim( ... )delim"
+    qsizetype open = i + 1;
+    while (open < m_size && open - i <= 17 && m_data[open] != '(') {
+        const char c = m_data[open];
+        if (isSpace(c) || c == '\\' || c == ')' || c == '"')
+            return skipString(i, '"');
+        ++open;
+    }
+    if (open >= m_size || m_data[open] != '(')
+        return skipString(i, '"');
+
+    const QByteArray terminator = ')' + m_content.sliced(i + 1, open - i - 1).toByteArray() + '"';
+    const qsizetype end = m_content.indexOf(terminator, open + 1);
+    return end < 0 ? m_size : end + terminator.size();
+}
+
+qsizetype Scanner::skipPreprocessor(qsizetype i) const
+{
+    while (i < m_size) {
+        const qsizetype newline = skipLineComment(i);
+        qsizetype last = newline - 1;
+        if (last >= 0 && m_data[last] == '\r')
+            --last;
+        // Continuación con barra invertida
+        if (newline < m_size && last >= i && m_data[last] == '\\') {
+            i = newline + 1;
+            continue;
+        }
+        return newline;
+    }
+    return m_size;
+}
+
+qsizetype Scanner::restOfLine(qsizetype i) const
+{
+    // La unidad se queda con el ';' y el comentario que cierren su línea
+    qsizetype j = i;
+    while (j < m_size && (m_data[j] == ' ' || m_data[j] == '\t' || m_data[j] == '\r' || m_data[j] == ';'))
+        ++j;
+    if (j + 1 < m_size && m_data[j] == '/' && m_data[j + 1] == '/')
+        j = skipLineComment(j);
+    if (j >= m_size)
+        return m_size;
+    return m_data[j] == '\n' ? j + 1 : i;
+}
+
+} // namespace
+
+DeepSeekCodeChunker::Language DeepSeekCodeChunker::languageFor(QStringView path)
+{
+    const qsizetype dot = path.lastIndexOf('.');
+    if (dot < 0)
+        return PlainText;
+    const QStringView suffix = path.sliced(dot + 1);
+
+    static const char *const cpp[] = {"h", "hh", "hpp", "hxx", "h++", "c", "cc", "cpp", "cxx",
+                                      "c++", "ipp", "inl", "tpp", "m", "mm"};
+    for (const char *candidate : cpp) {
+        if (suffix.compare(QLatin1StringView(candidate), Qt::CaseInsensitive) == 0)
+            return Cpp;
+    }
+    if (suffix.compare(QLatin1StringView("qml"), Qt::CaseInsensitive) == 0
+        || suffix.compare(QLatin1StringView("js"), Qt::CaseInsensitive) == 0
+        || suffix.compare(QLatin1StringView("mjs"), Qt::CaseInsensitive) == 0) {
+        return Qml;
+    }
+    return PlainText;
+}
+
+QList<DeepSeekCodeChunker::Unit> DeepSeekCodeChunker::split(QByteArrayView content, Language language,
+                                                         bool countTokens)
+{
+    QList<Unit> units;
+    if (content.isEmpty())
+        return units;
+
+    if (language == PlainText) {
+        Unit unit;
+        unit.kind = Unit::Block;
+        unit.end = content.size();
+        units.append(unit);
+    } else {
+        units = Scanner(content, language).run();
+    }
+
+    // Líneas y tokens de cada unidad
+    int line = 1;
+    for (Unit &unit : units) {
+        const QByteArrayView text = content.sliced(unit.begin, unit.end - unit.begin);
+        const int newlines = int(text.count('\n'));
+        unit.firstLine = line;
+        unit.lineCount = newlines + (text.endsWith('\n') ? 0 : 1);
+        if (countTokens)
+            unit.tokens = DeepSeekTokenEstimator::estimate(QString::fromUtf8(text));
+        line += newlines;
+    }
+    return units;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QList>
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Divide ficheros C++/QML en unidades completas para construir prompts.
+//
+// Una sola pasada lineal sobre el UTF-8, sin análisis sintáctico: solo se
+// siguen llaves, paréntesis, comentarios, literales (incluidos los raw
+// strings) y directivas del preprocesador. Cada definición de nivel
+// superior (clase, función, objeto QML) es una unidad que incluye los
+// comentarios que la preceden; los namespaces y el objeto raíz de un QML
+// son transparentes, así que sus miembros salen como unidades propias. Las
+// declaraciones sueltas consecutivas (includes, usings, propiedades QML)
+// se agrupan en una sola unidad.
+//
+// Las unidades cubren el fichero entero, sin huecos y en orden.
+class DeepSeekCodeChunker
+{
+public:
+    enum Language { Cpp, Qml, PlainText };
+
+    struct Unit {
+        enum Kind { Declarations, Class, Function, QmlObject, Block };
+
+        Kind kind = Declarations;
+        qsizetype begin = 0;    // rango de bytes en el contenido
+        qsizetype end = 0;
+        int firstLine = 1;      // 1-based
+        int lineCount = 0;
+        int tokens = 0;         // estimación de DeepSeekTokenEstimator
+    };
+
+    static Language languageFor(QStringView path);
+
+    // Sin countTokens, Unit::tokens queda a 0 (el índice de búsqueda no lo usa)
+    static QList<Unit> split(QByteArrayView content, Language language, bool countTokens = true);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
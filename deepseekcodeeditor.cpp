@@ -1,10 +1,22 @@
 #include "deepseekcodeeditor.h"
+#include "deepseekcodechunker.h"
+#include "deepseektextdiff.h"
 
 #include <coreplugin/editormanager/editormanager.h>
 #include <texteditor/texteditor.h>
 #include <texteditor/textdocument.h>
 #include <utils/fileutils.h>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPointer>
+#include <QSaveFile>
+#include <QTextBlock>
 #include <QTextCursor>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <memory>
 
 using namespace Core;
 using namespace TextEditor;
@@ -13,6 +25,64 @@ using namespace Utils;
 namespace DeepSeekAI {
 namespace Internal {
 
+namespace {
+
+// Una unidad más larga (una clase enorme) no se envía entera: se usa una
+// ventana de kWindowLines alrededor del cursor
+const int kMaxScopeLines = 200;
+const int kWindowLines = 40;
+// Contexto de solo lectura a cada lado del fragmento
+const int kContextLines = 12;
+const int kMaxDeclarationLines = 60;
+// Veces que se recalcula el diff si el documento cambia mientras tanto
+const int kMaxReplaceAttempts = 3;
+
+// Texto de las líneas [first, last] (1-based), con el último salto de línea
+QString linesText(QTextDocument *document, int first, int last, int *position = nullptr,
+                  int *length = nullptr)
+{
+    const QTextBlock begin = document->findBlockByNumber(first - 1);
+    const QTextBlock end = document->findBlockByNumber(last - 1);
+    if (!begin.isValid() || !end.isValid() || first > last)
+        return {};
+    // El último bloque no tiene separador de párrafo que seleccionar
+    const int stop = qMin(end.position() + end.length(), document->characterCount() - 1);
+    QTextCursor cursor(document);
+    cursor.setPosition(begin.position());
+    cursor.setPosition(stop, QTextCursor::KeepAnchor);
+    if (position)
+        *position = begin.position();
+    if (length)
+        *length = stop - begin.position();
+    return cursor.selection().toPlainText();
+}
+
+// La respuesta del modelo suele venir entre ``` aunque se le pida solo código
+QString stripCodeFence(const QString &text)
+{
+    QStringView view(text);
+    const QStringView trimmed = view.trimmed();
+    if (trimmed.startsWith(u"```")) {
+        const qsizetype firstNewline = trimmed.indexOf(u'\n');
+        const qsizetype closing = trimmed.lastIndexOf(u"```");
+        if (firstNewline >= 0 && closing > firstNewline)
+            view = trimmed.sliced(firstNewline + 1, closing - firstNewline - 1);
+    }
+    // Las líneas en blanco de los extremos sobran; la sangría de la primera no
+    while (!view.isEmpty() && view.back().isSpace())
+        view.chop(1);
+    qsizetype lineStart = 0;
+    for (qsizetype i = 0; i < view.size(); ++i) {
+        if (view.at(i) == u'\n')
+            lineStart = i + 1;
+        else if (!view.at(i).isSpace())
+            break;
+    }
+    return view.sliced(lineStart).toString();
+}
+
+} // namespace
+
 DeepSeekCodeEditor::DeepSeekCodeEditor(QObject *parent)
     : QObject(parent)
 {
@@ -38,6 +108,11 @@ bool DeepSeekCodeEditor::hasActiveEditor() const
     return m_currentEditor != nullptr && m_currentDocument != nullptr;
 }
 
+TextEditor::TextEditorWidget *DeepSeekCodeEditor::currentEditorWidget() const
+{
+    return m_currentEditor ? m_currentEditor->editorWidget() : nullptr;
+}
+
 QString DeepSeekCodeEditor::currentFileContent() const
 {
     return hasActiveEditor() ? m_currentDocument->plainText() : QString();
@@ -60,11 +135,182 @@ void DeepSeekCodeEditor::replaceCurrentFileContent(const QString &newContent)
         return;
     }
 
-    QTextCursor cursor(m_currentDocument->document());
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(newContent);
+    replaceDocumentContent(m_currentDocument, newContent, 1);
+}
+
+void DeepSeekCodeEditor::replaceDocumentContent(TextDocument *textDocument,
+                                                const QString &newContent, int attempt)
+{
+    // Solo se tocan los tramos que cambian: el resaltado, el modelo de
+    // código, el cursor, los plegados y los marcadores del resto se
+    // conservan. El diff se calcula fuera del hilo de la interfaz
+    QPointer<TextDocument> document = textDocument;
+    const QString filePath = document->filePath().toUserOutput();
+    const QString oldContent = document->plainText();
+    const int revision = document->document()->revision();
+
+    using Edits = QList<DeepSeekTextDiff::Edit>;
+    auto *watcher = new QFutureWatcher<Edits>(this);
+    connect(watcher, &QFutureWatcher<Edits>::finished,
+            this, [this, watcher, document, filePath, revision, newContent, attempt]() {
+        watcher->deleteLater();
+        if (!document) {
+            emit contentReplaced(filePath, false);
+            return;
+        }
+        // El documento cambió mientras se calculaba: otra vez sobre el
+        // mismo documento, aunque ya no sea el actual
+        if (document->document()->revision() != revision) {
+            if (attempt < kMaxReplaceAttempts)
+                replaceDocumentContent(document, newContent, attempt + 1);
+            else
+                emit contentReplaced(filePath, false);
+            return;
+        }
+        applyEdits(document->document(), watcher->result());
+        emit contentReplaced(filePath, true);
+    });
+    watcher->setFuture(QtConcurrent::run([oldContent, newContent]() {
+        return DeepSeekTextDiff::compute(oldContent, newContent);
+    }));
+}
+
+DeepSeekFixScope DeepSeekCodeEditor::currentFixScope() const
+{
+    DeepSeekFixScope scope;
+    if (!hasActiveEditor())
+        return scope;
+
+    QTextDocument *document = m_currentDocument->document();
+    const QTextCursor cursor = m_currentEditor->editorWidget()->textCursor();
+    const int lineCount = document->blockCount();
+    int first = 0;
+    int last = 0;
+
+    const QByteArray content = document->toPlainText().toUtf8();
+    const QList<DeepSeekCodeChunker::Unit> units = DeepSeekCodeChunker::split(
+        content, DeepSeekCodeChunker::languageFor(m_currentDocument->filePath().fileName()), false);
+
+    if (cursor.hasSelection()) {
+        first = document->findBlock(cursor.selectionStart()).blockNumber() + 1;
+        const QTextBlock endBlock = document->findBlock(cursor.selectionEnd());
+        // Una selección que acaba al principio de una línea no la incluye
+        last = endBlock.blockNumber() + (cursor.selectionEnd() == endBlock.position() ? 0 : 1);
+        last = qMax(first, last);
+    } else {
+        const int line = cursor.blockNumber() + 1;
+        for (const DeepSeekCodeChunker::Unit &unit : units) {
+            if (line < unit.firstLine || line >= unit.firstLine + unit.lineCount)
+                continue;
+            if (unit.kind != DeepSeekCodeChunker::Unit::Declarations
+                && unit.lineCount <= kMaxScopeLines) {
+                first = unit.firstLine;
+                last = unit.firstLine + unit.lineCount - 1;
+            }
+            break;
+        }
+        if (first == 0) {
+            first = qMax(1, line - kWindowLines / 2);
+            last = qMin(lineCount, line + kWindowLines / 2);
+        }
+    }
+
+    // Una unidad empieza justo tras la anterior: sin recortar, las líneas en
+    // blanco de delante entrarían en el ámbito y el diff las borraría
+    auto isBlank = [document](int line) {
+        return document->findBlockByNumber(line - 1).text().trimmed().isEmpty();
+    };
+    while (first < last && isBlank(first))
+        ++first;
+    while (last > first && isBlank(last))
+        --last;
+
+    scope.filePath = m_currentDocument->filePath().toUserOutput();
+    scope.revision = document->revision();
+    scope.firstLine = first;
+    scope.lastLine = last;
+    scope.code = linesText(document, first, last, &scope.position, &scope.length);
+    const int beforeFirst = qMax(1, first - kContextLines);
+    if (beforeFirst < first)
+        scope.before = linesText(document, beforeFirst, first - 1);
+    const int afterLast = qMin(lineCount, last + kContextLines);
+    if (afterLast > last)
+        scope.after = linesText(document, last + 1, afterLast);
+
+    // Includes, usings y declaraciones sueltas anteriores al contexto
+    int declarationLines = 0;
+    for (const DeepSeekCodeChunker::Unit &unit : units) {
+        if (unit.firstLine + unit.lineCount > beforeFirst)
+            break;
+        if (unit.kind != DeepSeekCodeChunker::Unit::Declarations)
+            continue;
+        if (declarationLines + unit.lineCount > kMaxDeclarationLines)
+            break;
+        scope.declarations += QString::fromUtf8(
+            QByteArrayView(content).sliced(unit.begin, unit.end - unit.begin));
+        declarationLines += unit.lineCount;
+    }
+    return scope;
+}
+
+bool DeepSeekCodeEditor::applyScopedFix(const DeepSeekFixScope &scope, const QString &fixedCode)
+{
+    TextDocument *textDocument = TextDocument::textDocumentForFilePath(
+        FilePath::fromUserInput(scope.filePath));
+    if (!textDocument)
+        return false;
+    QTextDocument *document = textDocument->document();
+
+    // Si el documento cambió, el fragmento puede haberse movido
+    int position = scope.position;
+    if (document->revision() != scope.revision) {
+        const QString text = document->toPlainText();
+        if (QStringView(text).mid(position, scope.length) != scope.code) {
+            position = int(text.indexOf(scope.code));
+            if (position < 0 || text.indexOf(scope.code, position + 1) >= 0)
+                return false;
+        }
+    }
+
+    QString replacement = stripCodeFence(fixedCode);
+    if (scope.code.endsWith('\n') && !replacement.endsWith('\n'))
+        replacement += '\n';
+
+    // Fragmento pequeño: el diff se calcula aquí mismo
+    QList<DeepSeekTextDiff::Edit> edits = DeepSeekTextDiff::compute(scope.code, replacement);
+    for (DeepSeekTextDiff::Edit &edit : edits)
+        edit.position += position;
+    applyEdits(document, edits);
+    return true;
+}
+
+void DeepSeekCodeEditor::applyEdits(QTextDocument *document, const QList<DeepSeekTextDiff::Edit> &edits)
+{
+    if (edits.isEmpty())
+        return;
+
+    // Un solo paso de deshacer; de atrás adelante, así las posiciones
+    // pendientes siguen valiendo
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    for (auto it = edits.crbegin(); it != edits.crend(); ++it) {
+        cursor.setPosition(it->position);
+        cursor.setPosition(it->position + it->length, QTextCursor::KeepAnchor);
+        cursor.insertText(it->text);
+    }
+    cursor.endEditBlock();
+
+    publishEdit(document);
+}
 
-    emit contentChanged();
+void DeepSeekCodeEditor::publishEdit(QTextDocument *document)
+{
+    // El documento actual lo publica m_changeTracker (con su contentChanged());
+    // emitirlo aquí también lo duplicaría
+    if (m_changeTracker && m_changeTracker->document() == document)
+        m_changeTracker->flush();
+    else
+        emit contentChanged();
 }
 
 void DeepSeekCodeEditor::insertCodeAtCursor(const QString &code)
@@ -74,7 +320,24 @@ void DeepSeekCodeEditor::insertCodeAtCursor(const QString &code)
     }
 
     m_currentEditor->editorWidget()->insertPlainText(code);
-    emit contentChanged();
+    publishEdit(m_currentDocument->document());
+}
+
+DeepSeekEditorStream *DeepSeekCodeEditor::beginStreamAtCursor()
+{
+    if (!hasActiveEditor())
+        return nullptr;
+
+    const int position = m_currentEditor->editorWidget()->textCursor().position();
+    QPointer<QTextDocument> document = m_currentDocument->document();
+    auto *stream = new DeepSeekEditorStream(document, position, this);
+    connect(stream, &DeepSeekEditorStream::finished, this, [this, stream, document]() {
+        stream->deleteLater();
+        if (document)
+            publishEdit(document);
+    });
+    connect(stream, &DeepSeekEditorStream::rolledBack, stream, &QObject::deleteLater);
+    return stream;
 }
 
 void DeepSeekCodeEditor::insertCodeAtPosition(const QString &code, int line, int column)
@@ -83,13 +346,180 @@ void DeepSeekCodeEditor::insertCodeAtPosition(const QString &code, int line, int
         return;
     }
 
-    QTextCursor cursor(m_currentDocument->document());
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, line - 1);
-    cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, column);
-    cursor.insertText(code);
+    TextEdit edit;
+    edit.filePath = currentFilePath();
+    edit.line = line;
+    edit.column = column;
+    edit.text = code;
+    applyEditBatch({edit});
+}
+
+bool DeepSeekCodeEditor::applyEditBatch(const QList<TextEdit> &edits, QString *errorString)
+{
+    auto fail = [errorString](const QString &error) {
+        if (errorString)
+            *errorString = error;
+        return false;
+    };
+
+    // Ediciones de un fichero como rangos absolutos, en orden
+    struct Range {
+        int position;
+        int length;
+        QString text;
+    };
+    struct Target {
+        QString filePath;
+        QPointer<TextDocument> document;   // nulo: fichero cerrado
+        QByteArray original;               // bytes en disco, para deshacer
+        QString diskContent;               // con \n, como un documento abierto
+        bool crlf = false;
+        QList<Range> ranges;
+    };
+
+    QHash<QString, int> targetIndex;
+    QList<Target> targets;
+    QList<QList<const TextEdit *>> editsByTarget;
+    for (const TextEdit &edit : edits) {
+        int index = targetIndex.value(edit.filePath, -1);
+        if (index < 0) {
+            index = int(targets.size());
+            targetIndex.insert(edit.filePath, index);
+            Target target;
+            target.filePath = edit.filePath;
+            target.document = TextDocument::textDocumentForFilePath(
+                FilePath::fromUserInput(edit.filePath));
+            targets.append(target);
+            editsByTarget.append({});
+        }
+        editsByTarget[index].append(&edit);
+    }
+
+    // 1. Resolver y validar todo antes de modificar nada
+    for (int t = 0; t < targets.size(); ++t) {
+        Target &target = targets[t];
+        QTextDocument *document = target.document ? target.document->document() : nullptr;
+
+        // Para los ficheros cerrados, el principio de cada línea
+        QList<int> lineStarts;
+        if (!document) {
+            QFile file(target.filePath);
+            if (!file.open(QIODevice::ReadOnly))
+                return fail(tr("Cannot read %1: %2").arg(target.filePath, file.errorString()));
+            target.original = file.readAll();
+            target.diskContent = QString::fromUtf8(target.original);
+            // Las columnas cuentan igual que en un documento abierto, sin \r;
+            // al escribir se vuelve a los finales de línea del fichero
+            target.crlf = target.diskContent.contains(QLatin1String("\r\n"));
+            if (target.crlf)
+                target.diskContent.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+            lineStarts.append(0);
+            for (qsizetype i = target.diskContent.indexOf('\n'); i >= 0;
+                 i = target.diskContent.indexOf('\n', i + 1)) {
+                lineStarts.append(int(i + 1));
+            }
+        }
+
+        for (const TextEdit *edit : editsByTarget.at(t)) {
+            // Directamente por número de bloque: sin recorrer líneas ni
+            // depender de la maquetación
+            int lineStart = -1;
+            int lineLength = 0;
+            if (document) {
+                const QTextBlock block = document->findBlockByNumber(edit->line - 1);
+                if (block.isValid()) {
+                    lineStart = block.position();
+                    lineLength = block.length() - 1;
+                }
+            } else if (edit->line >= 1 && edit->line <= lineStarts.size()) {
+                lineStart = lineStarts.at(edit->line - 1);
+                const int next = edit->line < lineStarts.size()
+                                     ? lineStarts.at(edit->line) - 1
+                                     : int(target.diskContent.size());
+                lineLength = next - lineStart;
+            }
+            if (lineStart < 0 || edit->column < 0 || edit->column > lineLength || edit->length < 0)
+                return fail(tr("Invalid position %1:%2 in %3")
+                                .arg(edit->line).arg(edit->column).arg(target.filePath));
+            QString text = edit->text;
+            text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+            target.ranges.append({lineStart + edit->column, edit->length, text});
+        }
+
+        std::stable_sort(target.ranges.begin(), target.ranges.end(),
+                         [](const Range &a, const Range &b) { return a.position < b.position; });
+        const int size = document ? document->characterCount() - 1
+                                  : int(target.diskContent.size());
+        for (int i = 0; i < target.ranges.size(); ++i) {
+            const Range &range = target.ranges.at(i);
+            const int end = range.position + range.length;
+            if (end > size || (i + 1 < target.ranges.size()
+                               && end > target.ranges.at(i + 1).position)) {
+                return fail(tr("Overlapping or out of range edits in %1").arg(target.filePath));
+            }
+        }
+    }
+
+    // 2. Ficheros cerrados: todos preparados antes de confirmar ninguno
+    QList<std::shared_ptr<QSaveFile>> saveFiles;
+    QList<const Target *> saveTargets;
+    for (Target &target : targets) {
+        if (target.document)
+            continue;
+        for (auto it = target.ranges.crbegin(); it != target.ranges.crend(); ++it)
+            target.diskContent.replace(it->position, it->length, it->text);
+        if (target.crlf)
+            target.diskContent.replace(QLatin1Char('\n'), QLatin1String("\r\n"));
+        auto file = std::make_shared<QSaveFile>(target.filePath);
+        if (!file->open(QIODevice::WriteOnly) || file->write(target.diskContent.toUtf8()) < 0)
+            return fail(tr("Cannot write %1: %2").arg(target.filePath, file->errorString()));
+        saveFiles.append(file);
+        saveTargets.append(&target);
+    }
+    for (int i = 0; i < saveFiles.size(); ++i) {
+        if (saveFiles.at(i)->commit())
+            continue;
+        // Los ya confirmados vuelven a su contenido anterior
+        const QString error = tr("Cannot write %1: %2")
+                                  .arg(saveFiles.at(i)->fileName(), saveFiles.at(i)->errorString());
+        QStringList notRestored;
+        for (int j = 0; j < i; ++j) {
+            QSaveFile restore(saveTargets.at(j)->filePath);
+            if (!restore.open(QIODevice::WriteOnly)
+                || restore.write(saveTargets.at(j)->original) < 0 || !restore.commit()) {
+                notRestored.append(saveTargets.at(j)->filePath);
+            }
+        }
+        if (!notRestored.isEmpty())
+            return fail(error + tr("; could not restore %1").arg(notRestored.join(", ")));
+        return fail(error);
+    }
+    for (const std::shared_ptr<QSaveFile> &file : std::as_const(saveFiles))
+        emit fileSaved(file->fileName());
+
+    // 3. Documentos abiertos: de atrás adelante, un paso de deshacer cada uno
+    bool trackedDocument = false;
+    for (const Target &target : std::as_const(targets)) {
+        if (!target.document)
+            continue;
+        if (m_changeTracker && m_changeTracker->document() == target.document->document())
+            trackedDocument = true;
+        QTextCursor cursor(target.document->document());
+        cursor.beginEditBlock();
+        for (auto it = target.ranges.crbegin(); it != target.ranges.crend(); ++it) {
+            cursor.setPosition(it->position);
+            cursor.setPosition(it->position + it->length, QTextCursor::KeepAnchor);
+            cursor.insertText(it->text);
+        }
+        cursor.endEditBlock();
+    }
 
-    emit contentChanged();
+    // Un solo contentChanged() por lote: el del tracker si tocó el documento actual
+    if (trackedDocument)
+        m_changeTracker->flush();
+    else if (!targets.isEmpty())
+        emit contentChanged();
+    return true;
 }
 
 void DeepSeekCodeEditor::saveCurrentFile()
@@ -105,17 +535,24 @@ void DeepSeekCodeEditor::saveCurrentFile()
 
 void DeepSeekCodeEditor::onEditorChanged(Core::IEditor *editor)
 {
-    if (m_currentEditor) {
-        disconnect(m_currentDocument, &TextDocument::contentsChanged,
-                  this, &DeepSeekCodeEditor::contentChanged);
+    // Lo pendiente del documento anterior se publica antes de soltarlo
+    if (m_changeTracker) {
+        m_changeTracker->flush();
+        delete m_changeTracker;
+        m_changeTracker = nullptr;
     }
 
     m_currentEditor = qobject_cast<BaseTextEditor*>(editor);
     m_currentDocument = m_currentEditor ? m_currentEditor->textDocument() : nullptr;
 
     if (m_currentDocument) {
-        connect(m_currentDocument, &TextDocument::contentsChanged,
-                this, &DeepSeekCodeEditor::contentChanged);
+        m_changeTracker = new DeepSeekChangeTracker(m_currentDocument->document(), this);
+        const QString filePath = m_currentDocument->filePath().toUserOutput();
+        connect(m_changeTracker, &DeepSeekChangeTracker::changed,
+                this, [this, filePath](const DeepSeekChangeTracker::Delta &delta) {
+            emit documentEdited(filePath, delta);
+            emit contentChanged();
+        });
     }
 
     emit editorChanged();
@@ -1,9 +1,16 @@
 #ifndef DEEPSEEKCODEEDITOR_H
 #define DEEPSEEKCODEEDITOR_H
 
+#include "deepseekchangetracker.h"
+#include "deepseekeditorstream.h"
+#include "deepseekfixscope.h"
+#include "deepseektextdiff.h"
+
 #include <QObject>
 #include <texteditor/texteditor.h>
 
+class QTextDocument;
+
 namespace TextEditor {
 class BaseTextEditor;
 class TextDocument;
@@ -21,16 +28,52 @@ class DeepSeekCodeEditor : public QObject
     Q_OBJECT
 
 public:
+    // Una edición de un lote: sustituye length caracteres desde (line, column)
+    // por text; con length 0 es una inserción
+    struct TextEdit {
+        QString filePath;
+        int line = 1;           // 1-based
+        int column = 0;         // 0-based, en caracteres UTF-16
+        int length = 0;
+        QString text;
+    };
+
     explicit DeepSeekCodeEditor(QObject *parent = nullptr);
     ~DeepSeekCodeEditor();
 
     bool hasActiveEditor() const;
+    // nullptr si no hay editor
+    TextEditor::TextEditorWidget *currentEditorWidget() const;
     QString currentFileContent() const;
     QString currentFileName() const;
     QString currentFilePath() const;
+    // Aplica newContent como diferencias mínimas, en un solo paso de deshacer;
+    // el cambio llega al documento de forma asíncrona y contentReplaced()
+    // dice si se aplicó
     void replaceCurrentFileContent(const QString &newContent);
+    // La selección (líneas completas) o la unidad del cursor según
+    // DeepSeekCodeChunker, con su contexto; inválido si no hay editor
+    DeepSeekFixScope currentFixScope() const;
+    // Sustituye solo el rango de scope, aunque el documento haya cambiado
+    // fuera de él; false si el fragmento original ya no está
+    bool applyScopedFix(const DeepSeekFixScope &scope, const QString &fixedCode);
     void insertCodeAtCursor(const QString &code);
+    // Destino para una respuesta en streaming, anclado en el cursor; se
+    // destruye solo al terminar o deshacerse. nullptr si no hay editor
+    DeepSeekEditorStream *beginStreamAtCursor();
     void insertCodeAtPosition(const QString &code, int line, int column);
+    // Aplica todas las ediciones o ninguna: se validan antes de tocar nada
+    // (posiciones, solapes, ficheros legibles). Cada documento abierto
+    // recibe sus ediciones de atrás adelante en un solo paso de deshacer;
+    // los ficheros que no están abiertos se editan directamente en disco
+    // (columnas sin contar \r, como en un documento abierto) y, si falla
+    // la escritura de uno, los ya escritos se restauran. contentChanged()
+    // se emite una vez por lote
+    bool applyEditBatch(const QList<TextEdit> &edits, QString *errorString = nullptr);
+
+    // Cambios del documento actual agrupados (ver DeepSeekChangeTracker);
+    // nullptr si no hay editor
+    DeepSeekChangeTracker *changeTracker() const { return m_changeTracker; }
     void saveCurrentFile();
 
 public slots:
@@ -38,12 +81,27 @@ public slots:
 
 signals:
     void editorChanged();
+    // Una vez por ráfaga de cambios, no por pulsación
     void contentChanged();
+    // Lo mismo con el cambio: aplicado a la copia anterior del texto de
+    // filePath, da el texto actual
+    void documentEdited(const QString &filePath,
+                        const DeepSeekAI::Internal::DeepSeekChangeTracker::Delta &delta);
     void fileSaved(const QString &filePath);
+    // Resultado de replaceCurrentFileContent(): false si el documento se
+    // cerró o no dejó de cambiar mientras se calculaba el diff
+    void contentReplaced(const QString &filePath, bool applied);
 
 private:
+    void replaceDocumentContent(TextEditor::TextDocument *textDocument,
+                                const QString &newContent, int attempt);
+    void applyEdits(QTextDocument *document, const QList<DeepSeekTextDiff::Edit> &edits);
+    // contentChanged() una vez por edición programática de document
+    void publishEdit(QTextDocument *document);
+
     TextEditor::BaseTextEditor *m_currentEditor = nullptr;
     TextEditor::TextDocument *m_currentDocument = nullptr;
+    DeepSeekChangeTracker *m_changeTracker = nullptr;
 };
 
 } // namespace Internal
@@ -0,0 +1,67 @@
+#include "deepseekcompletioncache.h"
+
+namespace DeepSeekAI {
+namespace Internal {
+
+DeepSeekCompletionCache::DeepSeekCompletionCache(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+}
+
+void DeepSeekCompletionCache::insert(QStringView prefix, QStringView lineSuffix,
+                                     const QString &completion)
+{
+    if (completion.isEmpty())
+        return;
+
+    const QStringView key = prefix.right(KeyChars);
+    for (qsizetype i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).key == key && m_entries.at(i).lineSuffix == lineSuffix) {
+            m_entries.removeAt(i);
+            break;
+        }
+    }
+    if (m_entries.size() >= m_capacity)
+        m_entries.removeFirst();
+    m_entries.append({key.toString(), lineSuffix.toString(), completion});
+}
+
+QString DeepSeekCompletionCache::lookup(QStringView prefix, QStringView lineSuffix)
+{
+    for (qsizetype i = m_entries.size() - 1; i >= 0; --i) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.lineSuffix != lineSuffix)
+            continue;
+        const int typed = typedLength(entry.key, entry.completion, prefix);
+        if (typed < 0)
+            continue;
+
+        const QString remaining = entry.completion.mid(typed);
+        // Usada: pasa al final
+        m_entries.move(i, m_entries.size() - 1);
+        ++m_hits;
+        return remaining;
+    }
+    ++m_misses;
+    return QString();
+}
+
+int DeepSeekCompletionCache::typedLength(QStringView key, QStringView completion,
+                                         QStringView prefix)
+{
+    const qsizetype maxTyped = qMin(completion.size() - 1, prefix.size() - key.size());
+    for (qsizetype typed = 0; typed <= maxTyped; ++typed) {
+        // Descarte barato antes de comparar las cadenas enteras
+        if (typed > 0 && prefix.back() != completion.at(typed - 1))
+            continue;
+        const QStringView before = prefix.chopped(typed);
+        if (!key.isEmpty() && before.back() != key.back())
+            continue;
+        if (prefix.endsWith(completion.left(typed)) && before.endsWith(key))
+            return int(typed);
+    }
+    return -1;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Completados en línea recientes, indexados por el texto anterior al cursor.
+//
+// Cada entrada guarda el final del prefijo con el que se pidió (KeyChars
+// caracteres), el resto de la línea tras el cursor y el texto propuesto.
+// Si después se escribe justo el principio de ese texto, lookup() devuelve
+// lo que falta sin volver a pedirlo: el prefijo actual termina en la clave
+// seguida de lo tecleado. Se descartan las entradas menos usadas.
+class DeepSeekCompletionCache
+{
+public:
+    static constexpr int KeyChars = 256;
+
+    explicit DeepSeekCompletionCache(int capacity = 64);
+
+    void insert(QStringView prefix, QStringView lineSuffix, const QString &completion);
+    // Lo que queda por mostrar de un completado anterior; vacío si no hay
+    QString lookup(QStringView prefix, QStringView lineSuffix);
+    void clear() { m_entries.clear(); }
+
+    int size() const { return int(m_entries.size()); }
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+
+    // Caracteres de completion que ya se han escrito si prefix es key más
+    // el principio de completion; -1 si no encaja o ya se escribió entero
+    static int typedLength(QStringView key, QStringView completion, QStringView prefix);
+
+private:
+    struct Entry {
+        QString key;
+        QString lineSuffix;
+        QString completion;
+    };
+
+    QList<Entry> m_entries;    // la más reciente al final
+    int m_capacity;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,123 @@
+#include "deepseekeditorstream.h"
+
+#include <QTextDocument>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Un frame a 60 Hz
+const int kFrameMs = 16;
+
+} // namespace
+
+DeepSeekEditorStream::DeepSeekEditorStream(QTextDocument *document, int position, QObject *parent)
+    : QObject(parent),
+      m_document(document),
+      m_begin(document),
+      m_end(document)
+{
+    m_begin.setPosition(position);
+    m_begin.setKeepPositionOnInsert(true);
+    m_end.setPosition(position);
+
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(kFrameMs);
+    connect(&m_frameTimer, &QTimer::timeout, this, [this]() { flush(false); });
+}
+
+int DeepSeekEditorStream::insertedLength() const
+{
+    return m_end.position() - m_begin.position();
+}
+
+void DeepSeekEditorStream::append(const QString &chunk)
+{
+    if (!m_active || chunk.isEmpty())
+        return;
+    m_received = true;
+    m_pending += chunk;
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void DeepSeekEditorStream::finish(const QString &content)
+{
+    if (!m_active)
+        return;
+    if (!m_received)
+        m_pending = content;
+    m_frameTimer.stop();
+    flush(true);
+    m_active = false;
+    emit finished();
+}
+
+void DeepSeekEditorStream::rollback()
+{
+    if (!m_active)
+        return;
+    m_frameTimer.stop();
+    m_pending.clear();
+    m_active = false;
+
+    // Dentro del mismo paso de deshacer si sigue siendo el último: el
+    // documento queda como estaba y deshacer no devuelve un código a medias
+    if (m_document && m_inserted && insertedLength() > 0) {
+        QTextCursor cursor(m_begin);
+        cursor.setPosition(m_end.position(), QTextCursor::KeepAnchor);
+        if (m_document->availableUndoSteps() == m_undoSteps)
+            cursor.joinPreviousEditBlock();
+        else
+            cursor.beginEditBlock();
+        cursor.removeSelectedText();
+        cursor.endEditBlock();
+    }
+    emit rolledBack();
+}
+
+void DeepSeekEditorStream::flush(bool final)
+{
+    if (!m_document)
+        return;
+
+    // Se inserta línea a línea hasta donde se pueda; una línea que empieza
+    // por ` espera a estar completa para saber si es una valla ```
+    QString text;
+    qsizetype i = 0;
+    while (i < m_pending.size()) {
+        const qsizetype newline = m_pending.indexOf('\n', i);
+        if (m_atLineStart && m_pending.at(i) == '`') {
+            if (newline < 0 && !final)
+                break;
+            const qsizetype lineEnd = newline < 0 ? m_pending.size() : newline;
+            if (QStringView(m_pending).sliced(i, lineEnd - i).startsWith(u"```")) {
+                i = newline < 0 ? m_pending.size() : newline + 1;
+                continue;
+            }
+        }
+        const qsizetype end = newline < 0 ? m_pending.size() : newline + 1;
+        text += QStringView(m_pending).sliced(i, end - i);
+        m_atLineStart = newline >= 0;
+        i = end;
+    }
+    m_pending.remove(0, i);
+    if (text.isEmpty())
+        return;
+
+    // El primer bloque abre el paso de deshacer; los siguientes se unen a
+    // él salvo que entre medias se haya editado el documento: entonces el
+    // último paso es del usuario y no hay que unirse a él
+    if (m_inserted && m_document->availableUndoSteps() == m_undoSteps)
+        m_end.joinPreviousEditBlock();
+    else
+        m_end.beginEditBlock();
+    m_end.insertText(text);
+    m_end.endEditBlock();
+    m_inserted = true;
+    m_undoSteps = m_document->availableUndoSteps();
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
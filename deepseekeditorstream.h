@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTextCursor>
+#include <QTimer>
+
+class QTextDocument;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Inserta en un documento una respuesta en streaming según llega.
+//
+// Los fragmentos se acumulan y se insertan como mucho una vez por frame,
+// así el resaltado y el modelo de código se ejecutan un número acotado de
+// veces aunque lleguen cientos de tokens por segundo. El texto va siempre
+// detrás de lo ya insertado, aunque el usuario edite en otra parte del
+// documento. El stream es un solo paso de deshacer mientras nadie más
+// toque el documento; si el usuario edita entre dos frames, lo que llega
+// después abre un paso nuevo en lugar de unirse al suyo. rollback() quita
+// todo lo insertado. Las líneas ``` con las que el modelo suele envolver el
+// código no se insertan.
+class DeepSeekEditorStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    DeepSeekEditorStream(QTextDocument *document, int position, QObject *parent = nullptr);
+
+    bool isActive() const { return m_active; }
+    int insertedLength() const;
+
+public slots:
+    void append(const QString &chunk);
+    // content: la respuesta completa, por si no llegó en fragmentos (caché,
+    // peticiones sin streaming)
+    void finish(const QString &content = QString());
+    void rollback();
+
+signals:
+    void finished();
+    void rolledBack();
+
+private:
+    void flush(bool final);
+
+    QPointer<QTextDocument> m_document;
+    QTextCursor m_begin;        // no se mueve con lo que se inserta en él
+    QTextCursor m_end;          // avanza con cada inserción
+    QString m_pending;          // recibido y aún sin insertar
+    QTimer m_frameTimer;
+    bool m_active = true;
+    bool m_received = false;
+    bool m_inserted = false;
+    bool m_atLineStart = true;
+    int m_undoSteps = -1;       // del documento tras la última inserción
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,141 @@
+#include "deepseekfileclassifier.h"
+
+#include <QLatin1StringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Directorios cuyo contenido nunca es código del proyecto. Las rutas son
+// absolutas, así que solo nombres que no puedan ser un directorio normal
+// por encima del proyecto (nada de "build")
+bool isGeneratedDirectory(QStringView name)
+{
+    static const QLatin1StringView names[] = {
+        QLatin1StringView(".git"), QLatin1StringView(".svn"), QLatin1StringView(".hg"),
+        QLatin1StringView(".qtc_clangd"), QLatin1StringView("CMakeFiles"),
+        QLatin1StringView("node_modules"), QLatin1StringView("__pycache__"),
+        QLatin1StringView(".rcc"), QLatin1StringView(".moc"), QLatin1StringView(".uic")};
+    for (QLatin1StringView generated : names) {
+        if (name == generated)
+            return true;
+    }
+    // Salida de AUTOMOC/AUTOUIC de CMake
+    return name.endsWith(u"_autogen");
+}
+
+bool isGeneratedFile(QStringView name)
+{
+    return name.startsWith(u"moc_") || name.startsWith(u"ui_") || name.startsWith(u"qrc_")
+           || name.endsWith(u".moc") || name.endsWith(u".pb.h") || name.endsWith(u".pb.cc")
+           || name.endsWith(u".min.js") || name == u"mocs_compilation.cpp";
+}
+
+bool isBinaryExtension(QStringView name)
+{
+    const qsizetype dot = name.lastIndexOf(u'.');
+    if (dot < 0)
+        return false;
+    const QStringView extension = name.sliced(dot + 1);
+    static const QLatin1StringView extensions[] = {
+        QLatin1StringView("png"), QLatin1StringView("jpg"), QLatin1StringView("jpeg"),
+        QLatin1StringView("gif"), QLatin1StringView("bmp"), QLatin1StringView("ico"),
+        QLatin1StringView("icns"), QLatin1StringView("webp"), QLatin1StringView("ttf"),
+        QLatin1StringView("otf"), QLatin1StringView("woff"), QLatin1StringView("woff2"),
+        QLatin1StringView("qm"), QLatin1StringView("pdf"), QLatin1StringView("zip"),
+        QLatin1StringView("gz"), QLatin1StringView("7z"), QLatin1StringView("so"),
+        QLatin1StringView("dll"), QLatin1StringView("dylib"), QLatin1StringView("a"),
+        QLatin1StringView("lib"), QLatin1StringView("o"), QLatin1StringView("obj"),
+        QLatin1StringView("exe"), QLatin1StringView("wav"), QLatin1StringView("mp3"),
+        QLatin1StringView("mp4"), QLatin1StringView("db"), QLatin1StringView("sqlite")};
+    for (QLatin1StringView binary : extensions) {
+        if (extension.compare(binary, Qt::CaseInsensitive) == 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+DeepSeekFileClassifier::Verdict DeepSeekFileClassifier::classifyPath(QStringView path, qint64 size,
+                                                                     qint64 maxFileBytes)
+{
+    if (size > maxFileBytes)
+        return TooLarge;
+
+    // Segmentos de la ruta, sin crear cadenas; vale con '/' y '\'
+    qsizetype start = 0;
+    for (qsizetype i = 0; i <= path.size(); ++i) {
+        if (i < path.size() && path.at(i) != u'/' && path.at(i) != u'\\')
+            continue;
+        const QStringView segment = path.sliced(start, i - start);
+        start = i + 1;
+        if (segment.isEmpty())
+            continue;
+        if (i == path.size()) {
+            if (isGeneratedFile(segment))
+                return Generated;
+            if (isBinaryExtension(segment))
+                return Binary;
+        } else if (isGeneratedDirectory(segment)) {
+            return Generated;
+        }
+    }
+    return Text;
+}
+
+DeepSeekFileClassifier::Verdict DeepSeekFileClassifier::classifyContent(QByteArrayView head,
+                                                                        bool truncated)
+{
+    const auto *p = reinterpret_cast<const uchar *>(head.data());
+    const auto *const end = p + head.size();
+
+    // BOM de UTF-16/32: texto, pero no UTF-8
+    if (head.size() >= 2 && ((p[0] == 0xFF && p[1] == 0xFE) || (p[0] == 0xFE && p[1] == 0xFF)))
+        return Binary;
+
+    while (p < end) {
+        const uchar c = *p;
+        if (c == 0)
+            return Binary;
+        if (c < 0x80) {
+            ++p;
+            continue;
+        }
+
+        int length = 0;
+        uchar min = 0x80;     // segundo byte permitido (evita formas largas y surrogates)
+        uchar max = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0)
+                min = 0xA0;
+            else if (c == 0xED)
+                max = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0)
+                min = 0x90;
+            else if (c == 0xF4)
+                max = 0x8F;
+        } else {
+            return Binary;
+        }
+
+        for (int i = 1; i < length; ++i) {
+            if (p + i == end)
+                return truncated ? Text : Binary;
+            const uchar next = p[i];
+            if (i == 1 ? (next < min || next > max) : (next < 0x80 || next > 0xBF))
+                return Binary;
+        }
+        p += length;
+    }
+    return Text;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Decide, antes de leer un fichero entero, si merece la pena enviarlo.
+//
+// classifyPath() solo mira la ruta y el tamaño (sin abrir el fichero):
+// límite de tamaño, directorios y nombres de ficheros generados (moc_,
+// ui_, qrc_, *_autogen, CMakeFiles) y extensiones binarias conocidas.
+// classifyContent() mira los primeros SniffBytes: un byte NUL o UTF-8
+// inválido indican un binario.
+class DeepSeekFileClassifier
+{
+public:
+    enum Verdict { Text, TooLarge, Generated, Binary };
+
+    static constexpr qint64 DefaultMaxFileBytes = 1024 * 1024;
+    static constexpr qsizetype SniffBytes = 4096;
+
+    static Verdict classifyPath(QStringView path, qint64 size,
+                                qint64 maxFileBytes = DefaultMaxFileBytes);
+    // truncated: head es el principio de un fichero más largo (una
+    // secuencia UTF-8 cortada al final no cuenta como inválida)
+    static Verdict classifyContent(QByteArrayView head, bool truncated);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
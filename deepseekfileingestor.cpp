@@ -0,0 +1,195 @@
+#include "deepseekfileingestor.h"
+#include "deepseekfileclassifier.h"
+#include "deepseekprojectindex.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QThread>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// A partir de este tamaño se proyecta el fichero en lugar de leerlo
+const qint64 kMapThreshold = 256 * 1024;
+// Ficheros por tarea del pool: bastantes para amortizar el reparto y
+// pocos para que los primeros resultados lleguen pronto
+const int kBatchSize = 32;
+
+} // namespace
+
+DeepSeekFileIngestor::DeepSeekFileIngestor(QObject *parent)
+    : QObject(parent),
+      m_maxFileBytes(DeepSeekFileClassifier::DefaultMaxFileBytes)
+{
+    // E/S de disco: más hilos que núcleos no ayuda y satura el disco
+    setMaxThreads(qMin(QThread::idealThreadCount(), 8));
+}
+
+DeepSeekFileIngestor::~DeepSeekFileIngestor()
+{
+    cancel();
+}
+
+void DeepSeekFileIngestor::setMaxThreads(int threads)
+{
+    m_pool.setMaxThreadCount(qMax(1, threads));
+}
+
+void DeepSeekFileIngestor::start(const QStringList &paths)
+{
+    cancel();
+
+    const quint64 generation = ++m_generation;
+    m_stats = Stats();
+    m_nextBatch = 0;
+    m_readyBatches.clear();
+    m_timer.start();
+    m_pendingBatches = int((paths.size() + kBatchSize - 1) / kBatchSize);
+
+    if (m_pendingBatches == 0) {
+        emit finished(m_stats);
+        return;
+    }
+
+    for (qsizetype first = 0; first < paths.size(); first += kBatchSize) {
+        const int batchIndex = int(first / kBatchSize);
+        const QStringList batch = paths.mid(first, kBatchSize);
+        const qint64 maxFileBytes = m_maxFileBytes;
+        m_pool.start([this, generation, batchIndex, batch, maxFileBytes]() {
+            QList<IngestedFile> files;
+            files.reserve(batch.size());
+            Stats counts;
+
+            for (const QString &path : batch) {
+                if (m_generation.load() != generation)
+                    return;
+
+                IngestedFile file;
+                file.path = path;
+                qint64 skippedBytes = 0;
+                switch (readFile(path, maxFileBytes, &file, &skippedBytes)) {
+                case Read:
+                    files.append(std::move(file));
+                    break;
+                case Skipped:
+                    ++counts.skipped;
+                    counts.skippedBytes += skippedBytes;
+                    break;
+                case Failed:
+                    ++counts.failed;
+                    break;
+                }
+            }
+
+            QMetaObject::invokeMethod(this, [this, generation, batchIndex, files, counts]() {
+                onBatchRead(generation, batchIndex, files, counts);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void DeepSeekFileIngestor::cancel()
+{
+    if (m_pendingBatches == 0)
+        return;
+
+    // Los lotes en cola se descartan; los que están leyendo lo dejan al
+    // ver que la generación cambió
+    ++m_generation;
+    m_pool.clear();
+    m_pendingBatches = 0;
+    m_readyBatches.clear();
+}
+
+void DeepSeekFileIngestor::onBatchRead(quint64 generation, int batch,
+                                       const QList<IngestedFile> &files, const Stats &counts)
+{
+    if (generation != m_generation.load())
+        return;
+
+    m_stats.files += int(files.size());
+    m_stats.failed += counts.failed;
+    m_stats.skipped += counts.skipped;
+    m_stats.skippedBytes += counts.skippedBytes;
+    for (const IngestedFile &file : files)
+        m_stats.bytes += file.content.size();
+
+    m_readyBatches.insert(batch, files);
+    while (!m_readyBatches.isEmpty() && m_readyBatches.firstKey() == m_nextBatch) {
+        const QList<IngestedFile> ready = m_readyBatches.take(m_nextBatch++);
+        if (!ready.isEmpty())
+            emit filesReady(ready);
+        // Un receptor puede haber cancelado o reiniciado la lectura
+        if (generation != m_generation.load())
+            return;
+    }
+
+    if (--m_pendingBatches == 0) {
+        m_stats.elapsedMs = m_timer.elapsed();
+        emit finished(m_stats);
+    }
+}
+
+DeepSeekFileIngestor::ReadResult DeepSeekFileIngestor::readFile(const QString &path,
+                                                                 qint64 maxFileBytes,
+                                                                 IngestedFile *file,
+                                                                 qint64 *skippedBytes)
+{
+    auto mapped = std::make_shared<QFile>(path);
+    QFile &source = *mapped;
+    if (!source.open(QIODevice::ReadOnly))
+        return Failed;
+
+    const qint64 size = source.size();
+    // Ruta y tamaño bastan para la mayoría: ni un byte leído
+    if (DeepSeekFileClassifier::classifyPath(path, size, maxFileBytes)
+        != DeepSeekFileClassifier::Text) {
+        *skippedBytes = size;
+        return Skipped;
+    }
+
+    file->mtimeMs = source.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch();
+
+    if (size >= kMapThreshold) {
+        if (const uchar *map = source.map(0, size)) {
+            const char *data = reinterpret_cast<const char *>(map);
+            const QByteArrayView head(data, qMin<qint64>(size, DeepSeekFileClassifier::SniffBytes));
+            if (DeepSeekFileClassifier::classifyContent(head, true)
+                != DeepSeekFileClassifier::Text) {
+                *skippedBytes = size - head.size();
+                return Skipped;
+            }
+            // Sin copia: el QFile, y con él la proyección, viaja con el lote
+            // y se cierra al soltar la última copia, en el hilo que sea
+            file->content = QByteArray::fromRawData(data, size);
+            file->hash = DeepSeekProjectIndex::contentHash(file->content);
+            mapped->moveToThread(nullptr);
+            file->mapping = std::move(mapped);
+            return Read;
+        }
+    }
+
+    // El principio primero: de un binario no se lee el resto
+    file->content = source.read(DeepSeekFileClassifier::SniffBytes);
+    const bool truncated = file->content.size() < size;
+    if (DeepSeekFileClassifier::classifyContent(file->content, truncated)
+        != DeepSeekFileClassifier::Text) {
+        *skippedBytes = size - file->content.size();
+        file->content.clear();
+        return Skipped;
+    }
+    if (truncated) {
+        file->content.reserve(size);
+        file->content += source.readAll();
+    }
+
+    if (source.error() != QFileDevice::NoError)
+        return Failed;
+    file->hash = DeepSeekProjectIndex::contentHash(file->content);
+    return Read;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
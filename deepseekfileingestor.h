@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+class QFile;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+struct IngestedFile
+{
+    QString path;
+    QByteArray content;   // UTF-8, tal cual está en disco
+    qint64 mtimeMs = 0;
+    quint64 hash = 0;     // DeepSeekProjectIndex::contentHash(content)
+    // De los grandes, content apunta a esta proyección sin copiarla: solo
+    // vale mientras viva algún IngestedFile que la comparta
+    std::shared_ptr<QFile> mapping;
+};
+
+// Lee los ficheros de un proyecto en un pool de hilos propio y acotado.
+//
+// Los ficheros se reparten en lotes; cada lote se lee en un hilo del pool
+// (los grandes se proyectan con QFile::map, sin copiarlos) y se entrega
+// con filesReady() en el hilo del objeto, sin convertir el contenido a
+// UTF-16. Los lotes se entregan en el orden de las rutas (un lote
+// adelantado espera al anterior), así el empaquetado posterior es
+// determinista. finished() llega después del último lote con el resumen
+// de la lectura.
+//
+// Antes de leer un fichero entero se descartan los demasiado grandes, los
+// generados y los binarios (DeepSeekFileClassifier): solo se leen los
+// primeros KB de un binario, y nada de los demás.
+class DeepSeekFileIngestor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        int files = 0;
+        int failed = 0;
+        int skipped = 0;          // grandes, generados o binarios
+        qint64 bytes = 0;
+        qint64 skippedBytes = 0;  // lo que no se llegó a leer de ellos
+        qint64 elapsedMs = 0;
+
+        double filesPerSecond() const { return elapsedMs > 0 ? files * 1000.0 / elapsedMs : 0.0; }
+        double bytesPerSecond() const { return elapsedMs > 0 ? bytes * 1000.0 / elapsedMs : 0.0; }
+    };
+
+    explicit DeepSeekFileIngestor(QObject *parent = nullptr);
+    ~DeepSeekFileIngestor() override;
+
+    void setMaxThreads(int threads);
+    int maxThreads() const { return m_pool.maxThreadCount(); }
+    // Las lecturas de mantenimiento no deben quitar CPU al editor
+    void setThreadPriority(QThread::Priority priority) { m_pool.setThreadPriority(priority); }
+    // Los ficheros mayores se descartan sin abrirlos
+    void setMaxFileSize(qint64 bytes) { m_maxFileBytes = bytes; }
+    qint64 maxFileSize() const { return m_maxFileBytes; }
+
+    bool isRunning() const { return m_pendingBatches > 0; }
+
+    // Cancela la lectura anterior si la hay
+    void start(const QStringList &paths);
+    void cancel();
+
+signals:
+    void filesReady(const QList<DeepSeekAI::Internal::IngestedFile> &files);
+    void finished(const DeepSeekAI::Internal::DeepSeekFileIngestor::Stats &stats);
+
+private:
+    enum ReadResult { Read, Skipped, Failed };
+
+    void onBatchRead(quint64 generation, int batch, const QList<IngestedFile> &files,
+                     const Stats &counts);
+
+    // skippedBytes: lo que no se leyó de un fichero descartado
+    static ReadResult readFile(const QString &path, qint64 maxFileBytes, IngestedFile *file,
+                               qint64 *skippedBytes);
+
+    // Los hilos del pool lo consultan para abandonar una lectura cancelada
+    std::atomic<quint64> m_generation = 0;
+    int m_pendingBatches = 0;
+    int m_nextBatch = 0;
+    QMap<int, QList<IngestedFile>> m_readyBatches;
+    Stats m_stats;
+    QElapsedTimer m_timer;
+    qint64 m_maxFileBytes;
+    // Último miembro: se destruye primero y espera a los lotes en curso
+    QThreadPool m_pool;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
+
+Q_DECLARE_METATYPE(DeepSeekAI::Internal::IngestedFile)
+Q_DECLARE_METATYPE(DeepSeekAI::Internal::DeepSeekFileIngestor::Stats)
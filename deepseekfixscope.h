@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Parte de un documento que abarca una corrección: la selección o la
+// función (clase, objeto QML) en el cursor. Solo code se sustituye; el
+// resto viaja en el prompt como contexto de solo lectura.
+struct DeepSeekFixScope
+{
+    QString filePath;
+    int position = 0;       // rango de code en el documento
+    int length = 0;
+    int firstLine = 0;      // 1-based
+    int lastLine = 0;
+    int revision = 0;       // del documento al capturar el fragmento
+    QString code;
+    QString before;         // unas líneas antes y después del rango
+    QString after;
+    QString declarations;   // includes, usings y declaraciones previas del fichero
+
+    bool isValid() const { return !filePath.isEmpty() && !code.isEmpty(); }
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
+
+Q_DECLARE_METATYPE(DeepSeekAI::Internal::DeepSeekFixScope)
@@ -0,0 +1,308 @@
+#include "deepseekinlinecompletion.h"
+#include "deepseekcodeeditor.h"
+#include "deepseekrequest.h"
+#include "deepseektool.h"
+#include "messagehelper.h"
+
+#include <texteditor/texteditor.h>
+#include <texteditor/textsuggestion.h>
+#include <utils/multitextcursor.h>
+#include <utils/textutils.h>
+
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+using namespace TextEditor;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+DeepSeekInlineCompletion::DeepSeekInlineCompletion(DeepSeekTool *tool,
+                                                   DeepSeekCodeEditor *codeEditor,
+                                                   QObject *parent)
+    : QObject(parent),
+      m_tool(tool),
+      m_codeEditor(codeEditor)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &DeepSeekInlineCompletion::requestCompletion);
+    connect(m_codeEditor, &DeepSeekCodeEditor::editorChanged,
+            this, &DeepSeekInlineCompletion::onEditorChanged);
+}
+
+DeepSeekInlineCompletion::~DeepSeekInlineCompletion()
+{
+    cancelRequest();
+    clearSuggestion();
+}
+
+void DeepSeekInlineCompletion::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+    m_enabled = enabled;
+    onEditorChanged();
+}
+
+void DeepSeekInlineCompletion::onEditorChanged()
+{
+    m_debounce.stop();
+    cancelRequest();
+    clearSuggestion();
+    for (const QMetaObject::Connection &connection : std::as_const(m_widgetConnections))
+        disconnect(connection);
+    m_widgetConnections.clear();
+
+    m_widget = m_enabled ? m_codeEditor->currentEditorWidget() : nullptr;
+    if (!m_widget)
+        return;
+
+    m_widgetConnections.append(
+        connect(m_widget, &TextEditorWidget::cursorPositionChanged,
+                this, &DeepSeekInlineCompletion::scheduleUpdate));
+    m_widgetConnections.append(
+        connect(m_widget->document(), &QTextDocument::contentsChange,
+                this, [this](int, int charsRemoved, int charsAdded) {
+            if (charsRemoved == 0 && charsAdded == 0)
+                return; // solo formato
+            m_edited = true;
+            m_pauseTimer.start();
+            scheduleUpdate();
+        }));
+}
+
+void DeepSeekInlineCompletion::scheduleUpdate()
+{
+    // Una sola pasada por pulsación (cambio de texto + movimiento del
+    // cursor), cuando el editor ya ha quitado su sugerencia anterior
+    if (m_updateQueued)
+        return;
+    m_updateQueued = true;
+    QMetaObject::invokeMethod(this, &DeepSeekInlineCompletion::update, Qt::QueuedConnection);
+}
+
+void DeepSeekInlineCompletion::update()
+{
+    m_updateQueued = false;
+    const bool edited = std::exchange(m_edited, false);
+
+    Context context;
+    if (!currentContext(&context)) {
+        m_debounce.stop();
+        cancelRequest();
+        clearSuggestion();
+        return;
+    }
+
+    // Solo se movió el cursor: lo pedido ya no vale
+    if (!edited) {
+        if (context.position == m_position)
+            return;
+        m_position = context.position;
+        m_debounce.stop();
+        cancelRequest();
+        clearSuggestion();
+        return;
+    }
+    m_position = context.position;
+
+    // La petición en curso sigue si lo escrito es el principio de lo recibido
+    if (m_request) {
+        const int typed = context.lineSuffix == m_requestContext.lineSuffix
+                              ? DeepSeekCompletionCache::typedLength(
+                                    QStringView(m_requestContext.prefix)
+                                        .right(DeepSeekCompletionCache::KeyChars),
+                                    m_received, context.prefix)
+                              : -1;
+        if (typed >= 0) {
+            m_typed = typed;
+            showSuggestion(m_received.mid(typed));
+            return;
+        }
+        cancelRequest();
+    }
+
+    const QString cached = m_cache.lookup(context.prefix, context.lineSuffix);
+    if (!cached.isEmpty()) {
+        m_debounce.stop();
+        showSuggestion(cached);
+        return;
+    }
+
+    clearSuggestion();
+
+    // Solo al final de la línea o delante de cierres: en mitad de código
+    // la propuesta casi nunca encaja
+    static const QString closing = ")]}>;,\"'";
+    for (const QChar c : std::as_const(context.lineSuffix)) {
+        if (!c.isSpace() && !closing.contains(c)) {
+            m_debounce.stop();
+            return;
+        }
+    }
+    m_debounce.start();
+}
+
+void DeepSeekInlineCompletion::requestCompletion()
+{
+    Context context;
+    if (m_request || !currentContext(&context) || context.prefix.trimmed().isEmpty())
+        return;
+
+    DeepSeekRequest *request = m_tool->requestCompletion(context.prefix, context.suffix);
+    if (!request)
+        return;
+
+    m_request = request;
+    m_requestContext = context;
+    m_received.clear();
+    m_typed = 0;
+    m_firstVisibleMs = -1;
+
+    // Las señales de una petición ya sustituida o cancelada se ignoran
+    connect(request, &DeepSeekRequest::partialContent, this, [this, request]() {
+        if (request == m_request)
+            onPartialContent();
+    });
+    connect(request, &DeepSeekRequest::finished, this, [this, request](const QString &content) {
+        if (request == m_request)
+            onFinished(request, content);
+    });
+    connect(request, &DeepSeekRequest::failed, this, [this, request](const QString &error) {
+        if (request != m_request)
+            return;
+        m_request = nullptr;
+        Utils::MessageHelper::showMessage(tr("Completado en línea: %1").arg(error),
+                                          Utils::MessageHelper::Silent);
+    });
+}
+
+void DeepSeekInlineCompletion::onPartialContent()
+{
+    DeepSeekRequest *request = m_request;
+    const QString content = request->content();
+    m_received = trimmedCompletion(content);
+
+    // Con MaxLines líneas ya no hace falta el resto
+    if (m_received.size() < content.size()) {
+        onFinished(request, m_received);
+        request->cancel();
+        return;
+    }
+    showSuggestion(m_received.mid(m_typed));
+}
+
+void DeepSeekInlineCompletion::onFinished(DeepSeekRequest *request, const QString &content)
+{
+    m_request = nullptr;
+    m_received = trimmedCompletion(content);
+    m_cache.insert(m_requestContext.prefix, m_requestContext.lineSuffix, m_received);
+    showSuggestion(m_received.mid(m_typed));
+
+    Utils::MessageHelper::showMessage(
+        tr("Completado en línea %1: primer texto visible a %2 ms de la última pulsación "
+           "(primer token %3 ms); caché %4 aciertos, %5 fallos")
+            .arg(request->id())
+            .arg(m_firstVisibleMs)
+            .arg(request->firstTokenMs())
+            .arg(m_cache.hits()).arg(m_cache.misses()),
+        Utils::MessageHelper::Silent);
+}
+
+bool DeepSeekInlineCompletion::currentContext(Context *context) const
+{
+    if (!m_enabled || !m_widget)
+        return false;
+
+    const QTextCursor cursor = m_widget->textCursor();
+    if (cursor.hasSelection() || m_widget->multiTextCursor().hasMultipleCursors())
+        return false;
+
+    const QTextBlock block = cursor.block();
+    const QString line = block.text();
+    const int column = cursor.positionInBlock();
+    context->position = cursor.position();
+    context->lineSuffix = line.mid(column);
+
+    // Líneas completas hacia atrás, para que el prefijo (y la clave de la
+    // caché) no dependa de dónde cae el límite de caracteres
+    QStringList lines{line.left(column)};
+    qsizetype size = column;
+    for (QTextBlock previous = block.previous(); previous.isValid() && size < PrefixChars;
+         previous = previous.previous()) {
+        lines.append(previous.text());
+        size += previous.length();
+    }
+    std::reverse(lines.begin(), lines.end());
+    context->prefix = lines.join(QLatin1Char('\n'));
+
+    context->suffix = context->lineSuffix;
+    for (QTextBlock next = block.next(); next.isValid() && context->suffix.size() < SuffixChars;
+         next = next.next()) {
+        context->suffix += QLatin1Char('\n');
+        context->suffix += next.text();
+    }
+    return true;
+}
+
+void DeepSeekInlineCompletion::cancelRequest()
+{
+    if (DeepSeekRequest *request = m_request.data()) {
+        m_request = nullptr;
+        request->cancel();
+    }
+    m_received.clear();
+    m_typed = 0;
+}
+
+void DeepSeekInlineCompletion::showSuggestion(const QString &text)
+{
+    QString shown = text;
+    while (!shown.isEmpty() && shown.back().isSpace())
+        shown.chop(1);
+    if (!m_widget || shown.isEmpty()) {
+        clearSuggestion();
+        return;
+    }
+
+    if (m_request && m_firstVisibleMs < 0)
+        m_firstVisibleMs = m_pauseTimer.isValid() ? m_pauseTimer.elapsed() : -1;
+
+    const ::Utils::Text::Position position
+        = ::Utils::Text::Position::fromCursor(m_widget->textCursor());
+    TextSuggestion::Data data;
+    data.range.begin = position;
+    data.range.end = position;
+    data.position = position;
+    data.text = shown;
+    m_widget->insertSuggestion(std::make_unique<TextSuggestion>(data, m_widget->document()));
+    m_suggestionShown = true;
+}
+
+void DeepSeekInlineCompletion::clearSuggestion()
+{
+    if (m_widget && m_suggestionShown)
+        m_widget->clearSuggestion();
+    m_suggestionShown = false;
+}
+
+QString DeepSeekInlineCompletion::trimmedCompletion(const QString &content)
+{
+    qsizetype end = -1;
+    for (int line = 0; line < MaxLines; ++line) {
+        end = content.indexOf(QLatin1Char('\n'), end + 1);
+        if (end < 0)
+            return content;
+    }
+    return content.left(end);
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
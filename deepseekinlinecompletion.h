@@ -0,0 +1,94 @@
+#pragma once
+
+#include "deepseekcompletioncache.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+namespace TextEditor {
+class TextEditorWidget;
+}
+
+namespace DeepSeekAI {
+namespace Internal {
+
+class DeepSeekCodeEditor;
+class DeepSeekRequest;
+class DeepSeekTool;
+
+// Completado en línea: texto fantasma (sugerencia de TextEditor, Tab la
+// acepta) con lo que el modelo propone en el cursor.
+//
+// Tras DebounceMs sin escribir se pide un fill-in-the-middle con el texto
+// anterior y posterior al cursor, en streaming: la sugerencia crece según
+// llegan tokens. Si el cursor se mueve o el prefijo cambia de forma que
+// la propuesta ya no encaja, la petición en curso se cancela; si lo
+// escrito es justo el principio de la propuesta, sigue y solo se recorta.
+// Las propuestas terminadas van a DeepSeekCompletionCache, así que seguir
+// escribiendo sobre una de ellas no genera peticiones nuevas.
+class DeepSeekInlineCompletion : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DebounceMs = 120;
+    static constexpr int PrefixChars = 4000;
+    static constexpr int SuffixChars = 1500;
+    static constexpr int MaxLines = 12;
+
+    DeepSeekInlineCompletion(DeepSeekTool *tool, DeepSeekCodeEditor *codeEditor,
+                             QObject *parent = nullptr);
+    ~DeepSeekInlineCompletion() override;
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+private:
+    struct Context {
+        int position = -1;
+        QString prefix;         // desde el principio de una línea hasta el cursor
+        QString suffix;         // desde el cursor
+        QString lineSuffix;     // resto de la línea del cursor
+    };
+
+    void onEditorChanged();
+    void scheduleUpdate();
+    void update();
+    void requestCompletion();
+    void onPartialContent();
+    void onFinished(DeepSeekRequest *request, const QString &content);
+
+    bool currentContext(Context *context) const;
+    void cancelRequest();
+    void showSuggestion(const QString &text);
+    void clearSuggestion();
+    static QString trimmedCompletion(const QString &content);
+
+    DeepSeekTool *m_tool;
+    DeepSeekCodeEditor *m_codeEditor;
+    QPointer<TextEditor::TextEditorWidget> m_widget;
+    QList<QMetaObject::Connection> m_widgetConnections;
+    bool m_enabled = false;
+
+    QTimer m_debounce;
+    bool m_updateQueued = false;
+    bool m_edited = false;      // hubo texto nuevo desde el último update()
+    bool m_suggestionShown = false;
+    int m_position = -1;        // del cursor en el último update()
+
+    // Petición en curso y lo ya recibido de ella
+    QPointer<DeepSeekRequest> m_request;
+    Context m_requestContext;
+    QString m_received;
+    int m_typed = 0;            // caracteres de m_received escritos desde que se pidió
+    QElapsedTimer m_pauseTimer; // desde la última pulsación, para medir la latencia
+    qint64 m_firstVisibleMs = -1;
+
+    DeepSeekCompletionCache m_cache;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
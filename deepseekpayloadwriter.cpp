@@ -0,0 +1,238 @@
+#include "deepseekpayloadwriter.h"
+
+#include <QLocale>
+
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Escape JSON para cada carácter ASCII: 0 = se copia tal cual,
+// 'u' = \u00XX, cualquier otro valor = barra invertida + ese carácter
+constexpr char kEscape[128] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+constexpr quint64 kLaneOnes = 0x0001000100010001ULL;
+constexpr quint64 kLaneHigh = 0x8000800080008000ULL;
+
+inline bool hasZeroLane(quint64 v)
+{
+    return ((v - kLaneOnes) & ~v & kLaneHigh) != 0;
+}
+
+// Cuatro unidades UTF-16 ASCII que no necesitan escape (SWAR en 64 bits)
+inline bool isPlainAsciiBlock(const char16_t *p)
+{
+    quint64 w;
+    std::memcpy(&w, p, sizeof(w));
+    if (w & 0xFF80FF80FF80FF80ULL)
+        return false;
+    if (((w - 0x20 * kLaneOnes) & ~w & kLaneHigh) != 0)   // control < 0x20
+        return false;
+    return !hasZeroLane(w ^ ('"' * kLaneOnes)) && !hasZeroLane(w ^ ('\\' * kLaneOnes));
+}
+
+inline char *appendLiteral(char *out, const char *literal)
+{
+    const size_t length = std::strlen(literal);
+    std::memcpy(out, literal, length);
+    return out + length;
+}
+
+inline char *appendBytes(char *out, const QByteArray &bytes)
+{
+    std::memcpy(out, bytes.constData(), size_t(bytes.size()));
+    return out + bytes.size();
+}
+
+} // namespace
+
+qsizetype DeepSeekPayloadWriter::jsonStringSize(QStringView text)
+{
+    qsizetype size = 2; // comillas
+    const char16_t *p = text.utf16();
+    const char16_t *end = p + text.size();
+
+    while (p < end) {
+        if (end - p >= 4 && isPlainAsciiBlock(p)) {
+            size += 4;
+            p += 4;
+            continue;
+        }
+
+        const char16_t c = *p++;
+        if (c < 0x80) {
+            const char escape = kEscape[c];
+            size += escape == 0 ? 1 : (escape == 'u' ? 6 : 2);
+        } else if (c < 0x800) {
+            size += 2;
+        } else if (QChar::isHighSurrogate(c) && p < end && QChar::isLowSurrogate(*p)) {
+            size += 4;
+            ++p;
+        } else {
+            size += 3; // BMP, o U+FFFD en lugar de un surrogate suelto
+        }
+    }
+
+    return size;
+}
+
+char *DeepSeekPayloadWriter::writeJsonString(char *out, QStringView text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    *out++ = '"';
+    const char16_t *p = text.utf16();
+    const char16_t *end = p + text.size();
+
+    while (p < end) {
+        if (end - p >= 4 && isPlainAsciiBlock(p)) {
+            out[0] = char(p[0]);
+            out[1] = char(p[1]);
+            out[2] = char(p[2]);
+            out[3] = char(p[3]);
+            out += 4;
+            p += 4;
+            continue;
+        }
+
+        char32_t c = *p++;
+        if (c < 0x80) {
+            const char escape = kEscape[c];
+            if (escape == 0) {
+                *out++ = char(c);
+            } else if (escape == 'u') {
+                out = appendLiteral(out, "\\u00");
+                *out++ = hexDigits[c >> 4];
+                *out++ = hexDigits[c & 0xF];
+            } else {
+                *out++ = '\\';
+                *out++ = escape;
+            }
+            continue;
+        }
+
+        if (QChar::isHighSurrogate(c) && p < end && QChar::isLowSurrogate(*p)) {
+            c = QChar::surrogateToUcs4(char16_t(c), *p++);
+            *out++ = char(0xF0 | (c >> 18));
+            *out++ = char(0x80 | ((c >> 12) & 0x3F));
+            *out++ = char(0x80 | ((c >> 6) & 0x3F));
+            *out++ = char(0x80 | (c & 0x3F));
+            continue;
+        }
+
+        if (QChar::isSurrogate(c))
+            c = QChar::ReplacementCharacter;
+
+        if (c < 0x800) {
+            *out++ = char(0xC0 | (c >> 6));
+            *out++ = char(0x80 | (c & 0x3F));
+        } else {
+            *out++ = char(0xE0 | (c >> 12));
+            *out++ = char(0x80 | ((c >> 6) & 0x3F));
+            *out++ = char(0x80 | (c & 0x3F));
+        }
+    }
+
+    *out++ = '"';
+    return out;
+}
+
+QByteArray DeepSeekPayloadWriter::write(const ChatCompletionRequest &request, bool includeStream)
+{
+    const QByteArray temperature = QByteArray::number(request.temperature, 'g',
+                                                      QLocale::FloatingPointShortest);
+    const QByteArray maxTokens = QByteArray::number(request.maxTokens);
+
+    // 1. Tamaño exacto de la salida
+    qsizetype size = std::strlen("{\"model\":") + jsonStringSize(request.model)
+                     + std::strlen(",\"messages\":[]");
+    for (const ChatMessage &message : request.messages) {
+        size += std::strlen("{\"role\":,\"content\":}")
+                + jsonStringSize(message.role) + jsonStringSize(message.content);
+    }
+    if (request.messages.size() > 1)
+        size += request.messages.size() - 1; // comas
+    size += std::strlen(",\"temperature\":") + temperature.size()
+            + std::strlen(",\"max_tokens\":") + maxTokens.size();
+    if (includeStream)
+        size += std::strlen(",\"stream\":") + (request.stream ? 4 : 5);
+    size += 1;
+
+    // 2. Escritura sobre un único buffer
+    QByteArray payload(size, Qt::Uninitialized);
+    char *out = payload.data();
+
+    out = appendLiteral(out, "{\"model\":");
+    out = writeJsonString(out, request.model);
+    out = appendLiteral(out, ",\"messages\":[");
+    for (qsizetype i = 0; i < request.messages.size(); ++i) {
+        const ChatMessage &message = request.messages.at(i);
+        if (i > 0)
+            *out++ = ',';
+        out = appendLiteral(out, "{\"role\":");
+        out = writeJsonString(out, message.role);
+        out = appendLiteral(out, ",\"content\":");
+        out = writeJsonString(out, message.content);
+        *out++ = '}';
+    }
+    out = appendLiteral(out, "],\"temperature\":");
+    out = appendBytes(out, temperature);
+    out = appendLiteral(out, ",\"max_tokens\":");
+    out = appendBytes(out, maxTokens);
+    if (includeStream) {
+        out = appendLiteral(out, ",\"stream\":");
+        out = appendLiteral(out, request.stream ? "true" : "false");
+    }
+    *out++ = '}';
+
+    Q_ASSERT(out == payload.constData() + payload.size());
+    return payload;
+}
+
+QByteArray DeepSeekPayloadWriter::write(const FimCompletionRequest &request)
+{
+    const QByteArray temperature = QByteArray::number(request.temperature, 'g',
+                                                      QLocale::FloatingPointShortest);
+    const QByteArray maxTokens = QByteArray::number(request.maxTokens);
+
+    const qsizetype size = std::strlen("{\"model\":") + jsonStringSize(request.model)
+                           + std::strlen(",\"prompt\":") + jsonStringSize(request.prompt)
+                           + std::strlen(",\"suffix\":") + jsonStringSize(request.suffix)
+                           + std::strlen(",\"temperature\":") + temperature.size()
+                           + std::strlen(",\"max_tokens\":") + maxTokens.size()
+                           + std::strlen(",\"stream\":") + (request.stream ? 4 : 5) + 1;
+
+    QByteArray payload(size, Qt::Uninitialized);
+    char *out = payload.data();
+
+    out = appendLiteral(out, "{\"model\":");
+    out = writeJsonString(out, request.model);
+    out = appendLiteral(out, ",\"prompt\":");
+    out = writeJsonString(out, request.prompt);
+    out = appendLiteral(out, ",\"suffix\":");
+    out = writeJsonString(out, request.suffix);
+    out = appendLiteral(out, ",\"temperature\":");
+    out = appendBytes(out, temperature);
+    out = appendLiteral(out, ",\"max_tokens\":");
+    out = appendBytes(out, maxTokens);
+    out = appendLiteral(out, ",\"stream\":");
+    out = appendLiteral(out, request.stream ? "true" : "false");
+    *out++ = '}';
+
+    Q_ASSERT(out == payload.constData() + payload.size());
+    return payload;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+struct ChatMessage
+{
+    QString role;
+    QString content;
+};
+
+struct ChatCompletionRequest
+{
+    QString model = "deepseek-chat";
+    QList<ChatMessage> messages;
+    double temperature = 0.7;
+    int maxTokens = 2000;
+    bool stream = false;
+};
+
+// Cuerpo de /beta/completions en modo fill-in-the-middle: el modelo genera
+// lo que va entre prompt (texto anterior al cursor) y suffix (posterior)
+struct FimCompletionRequest
+{
+    QString model = "deepseek-chat";
+    QString prompt;
+    QString suffix;
+    double temperature = 0.0;
+    int maxTokens = 128;
+    bool stream = true;
+};
+
+// Serializa el cuerpo de /chat/completions directamente a UTF-8 compacto.
+//
+// A diferencia de QJsonObject + QJsonDocument::toJson(), el prompt no se
+// copia a QJsonValue ni a la representación interna de QJson: primero se
+// calcula el tamaño exacto de la salida y luego se escapa cada cadena una
+// sola vez sobre un único buffer ya dimensionado. Los tramos ASCII sin
+// caracteres especiales se procesan de cuatro en cuatro unidades UTF-16.
+class DeepSeekPayloadWriter
+{
+public:
+    // Con includeStream = false el resultado es la forma canónica de la
+    // petición (la que usa la caché de respuestas como clave).
+    static QByteArray write(const ChatCompletionRequest &request, bool includeStream = true);
+    static QByteArray write(const FimCompletionRequest &request);
+
+    // Tamaño en bytes de la cadena JSON (con comillas) para el texto dado
+    static qsizetype jsonStringSize(QStringView text);
+    // Escribe la cadena JSON en out y devuelve el puntero al final
+    static char *writeJsonString(char *out, QStringView text);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
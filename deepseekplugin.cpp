@@ -6,10 +6,14 @@
 #include <coreplugin/actionmanager/actioncontainer.h>
 #include <coreplugin/actionmanager/command.h>
 #include <coreplugin/coreconstants.h>
+#include <coreplugin/documentmanager.h>
 #include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/idocument.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/messagemanager.h>
+#include <projectexplorer/project.h>
 #include <projectexplorer/projectexplorer.h>
+#include <projectexplorer/projectmanager.h>
 #include <projectexplorer/projecttree.h>
 #include <texteditor/texteditor.h>
 
@@ -17,6 +21,7 @@
 #include <QMainWindow>
 #include <QMenu>
 #include <QMessageBox>
+#include <QSettings>
 #include <QTimer>
 
 using namespace Core;
@@ -33,6 +38,7 @@ DeepSeekPlugin::DeepSeekPlugin()
 DeepSeekPlugin::~DeepSeekPlugin()
 {
     delete m_widget;
+    delete m_inlineCompletion;
     delete m_projectGenerator;
     delete m_tool;
     delete m_codeEditor;
@@ -46,6 +52,7 @@ bool DeepSeekPlugin::initialize(const QStringList &arguments, QString *errorStri
     m_tool = new DeepSeekTool(this);
     m_projectGenerator = new DeepSeekProjectGenerator(this);
     m_codeEditor = new DeepSeekCodeEditor(this);
+    m_inlineCompletion = new DeepSeekInlineCompletion(m_tool, m_codeEditor, this);
     m_widget = new DeepSeekWidget();
 
     initializeMenu();
@@ -57,6 +64,7 @@ bool DeepSeekPlugin::initialize(const QStringList &arguments, QString *errorStri
 void DeepSeekPlugin::extensionsInitialized()
 {
     m_tool->initialize();
+    m_tool->warmUpConnection();
     m_projectGenerator->initialize();
     // m_codeEditor->initialize();
 
@@ -72,6 +80,7 @@ ExtensionSystem::IPlugin::ShutdownFlag DeepSeekPlugin::aboutToShutdown()
     if (m_widget) {
         m_widget->prepareShutdown();
     }
+    m_inlineCompletion->setEnabled(false);
     return SynchronousShutdown;
 }
 
@@ -107,19 +116,72 @@ void DeepSeekPlugin::initializeMenu()
 
     // Separador entre grupos de acciones
     menu->addSeparator();
+
+    // El fichero actual va entero en el prefijo estable de los prompts
+    auto pinAction = new QAction(Tr::tr("Pin Current File to Prompt Context"), this);
+    Command *pinCmd = ActionManager::registerAction(pinAction, Constants::PIN_FILE_ACTION_ID);
+    connect(pinAction, &QAction::triggered, this, [this]() {
+        IDocument *document = EditorManager::currentDocument();
+        if (!document)
+            return;
+        const QString path = document->filePath().toUserOutput();
+        MessageManager::writeFlashing(m_tool->togglePinnedFile(path)
+                                          ? Tr::tr("[DeepSeek] Pinned %1").arg(path)
+                                          : Tr::tr("[DeepSeek] Unpinned %1").arg(path));
+    });
+    menu->addAction(pinCmd);
+
+    // Texto fantasma con lo que el modelo propone en el cursor (Tab lo acepta)
+    QSettings settings;
+    auto inlineAction = new QAction(Tr::tr("Inline Completions"), this);
+    inlineAction->setCheckable(true);
+    inlineAction->setChecked(settings.value("DeepSeekPlugin/InlineCompletions", false).toBool());
+    Command *inlineCmd = ActionManager::registerAction(inlineAction,
+                                                       Constants::INLINE_COMPLETION_ACTION_ID);
+    inlineCmd->setDefaultKeySequence(QKeySequence(Tr::tr("Ctrl+Alt+I")));
+    connect(inlineAction, &QAction::toggled, this, [this](bool enabled) {
+        QSettings().setValue("DeepSeekPlugin/InlineCompletions", enabled);
+        m_inlineCompletion->setEnabled(enabled);
+        MessageManager::writeFlashing(enabled ? Tr::tr("[DeepSeek] Inline completions enabled")
+                                              : Tr::tr("[DeepSeek] Inline completions disabled"));
+    });
+    m_inlineCompletion->setEnabled(inlineAction->isChecked());
+    menu->addAction(inlineCmd);
 }
 
 void DeepSeekPlugin::setupConnections()
 {
     connect(m_widget, &DeepSeekWidget::requestGenerated,
-            m_tool, &DeepSeekTool::sendRequest);
+            this, [this](const QString &prompt, const QString &mode) {
+        DeepSeekRequest *request = m_tool->sendRequest(prompt, mode);
+        if (!request || mode != "code" || !m_widget->streamsIntoEditor())
+            return;
+        // El código aparece en el editor mientras se genera; si la petición
+        // falla o se cancela, se quita entero
+        DeepSeekEditorStream *stream = m_codeEditor->beginStreamAtCursor();
+        if (!stream)
+            return;
+        connect(request, &DeepSeekRequest::partialContent, stream, &DeepSeekEditorStream::append);
+        connect(request, &DeepSeekRequest::finished, stream, &DeepSeekEditorStream::finish);
+        connect(request, &DeepSeekRequest::failed, stream, &DeepSeekEditorStream::rollback);
+        connect(request, &DeepSeekRequest::cancelled, stream, &DeepSeekEditorStream::rollback);
+    });
 
     connect(m_widget, &DeepSeekWidget::requestFixCode,
             m_tool, &DeepSeekTool::requestFix);
 
+    connect(m_widget, &DeepSeekWidget::requestScopedFix,
+            m_tool, &DeepSeekTool::requestScopedFix);
+
     connect(m_tool, &DeepSeekTool::responseReceived,
             m_widget, &DeepSeekWidget::onResponseReceived);
 
+    connect(m_tool, &DeepSeekTool::partialResponseReceived,
+            m_widget, &DeepSeekWidget::onPartialResponseReceived);
+
+    connect(m_tool, &DeepSeekTool::requestTimingsAvailable,
+            m_widget, &DeepSeekWidget::onRequestTimings);
+
     connect(m_tool, &DeepSeekTool::errorOccurred,
             m_widget, &DeepSeekWidget::onErrorOccurred);
 
@@ -127,10 +189,34 @@ void DeepSeekPlugin::setupConnections()
             m_widget, &DeepSeekWidget::onProgressChanged);
 
     connect(m_tool, &DeepSeekTool::fixReady, this, [this](const QString &fixedCode) {
-        if (m_codeEditor->hasActiveEditor()) {
+        if (m_codeEditor->hasActiveEditor())
             m_codeEditor->replaceCurrentFileContent(fixedCode);
+    });
+
+    // El diff se aplica de forma asíncrona: el aviso, cuando ya está hecho
+    connect(m_codeEditor, &DeepSeekCodeEditor::contentReplaced,
+            this, [](const QString &filePath, bool applied) {
+        if (applied) {
             MessageManager::writeFlashing(
                 Tr::tr("Code was automatically fixed by DeepSeek"));
+        } else {
+            MessageManager::writeDisrupting(
+                Tr::tr("The fixed code was not applied: %1 changed or was closed")
+                    .arg(filePath));
+        }
+    });
+
+    connect(m_tool, &DeepSeekTool::scopedFixReady,
+            this, [this](const DeepSeekFixScope &scope, const QString &fixedCode) {
+        if (m_codeEditor->applyScopedFix(scope, fixedCode)) {
+            MessageManager::writeFlashing(
+                Tr::tr("Lines %1-%2 of %3 were fixed by DeepSeek")
+                    .arg(scope.firstLine).arg(scope.lastLine)
+                    .arg(Utils::FilePath::fromUserInput(scope.filePath).fileName()));
+        } else {
+            MessageManager::writeDisrupting(
+                Tr::tr("The fixed code was not applied: %1 changed or was closed")
+                    .arg(scope.filePath));
         }
     });
 
@@ -143,11 +229,60 @@ void DeepSeekPlugin::setupConnections()
     connect(m_projectGenerator, &DeepSeekProjectGenerator::errorOccurred,
             m_widget, &DeepSeekWidget::onErrorOccurred);
 
+    connect(m_projectGenerator, &DeepSeekProjectGenerator::projectFilesCollected,
+            m_tool, &DeepSeekTool::analyzeProjectFiles);
+
+    connect(ProjectManager::instance(), &ProjectManager::startupProjectChanged,
+            this, &DeepSeekPlugin::indexProject);
+
+    // Ficheros guardados o cambiados en disco: el índice se pone al día en
+    // segundo plano (DeepSeekProjectSearch agrupa las ráfagas)
+    auto updateFiles = [this](const Utils::FilePaths &filePaths) {
+        QStringList paths;
+        paths.reserve(filePaths.size());
+        for (const Utils::FilePath &filePath : filePaths)
+            paths.append(filePath.toUserOutput());
+        m_tool->projectSearch()->updateFiles(paths);
+    };
+    connect(DocumentManager::instance(), &DocumentManager::filesChangedInternally,
+            this, updateFiles);
+    connect(DocumentManager::instance(), &DocumentManager::filesChangedExternally,
+            this, [updateFiles](const QSet<Utils::FilePath> &filePaths) {
+        updateFiles(Utils::FilePaths(filePaths.cbegin(), filePaths.cend()));
+    });
+    connect(m_codeEditor, &DeepSeekCodeEditor::fileSaved, this, [this](const QString &filePath) {
+        m_tool->projectSearch()->updateFiles({filePath});
+    });
+
     // Conectar la señal de Tool al Widget
     connect(m_tool, &DeepSeekTool::settingsChanged,
             m_widget, &DeepSeekWidget::onSettingsChanged);
 }
 
+void DeepSeekPlugin::indexProject(Project *project)
+{
+    disconnect(m_parsingConnection);
+    disconnect(m_fileListConnection);
+    if (!project) {
+        m_tool->projectSearch()->clear();
+        return;
+    }
+
+    // Cada recarga del proyecto (CMake, .pro) puede cambiar la lista de ficheros
+    m_parsingConnection = connect(project, &Project::anyParsingFinished,
+                                  this, [this, project](bool success) {
+        if (success)
+            m_tool->projectSearch()->setProjectFiles(DeepSeekProjectGenerator::projectFiles(project));
+    });
+    // Ficheros añadidos, borrados o renombrados en el árbol (incluido un
+    // checkout): con índice ya construido solo se sincroniza la diferencia
+    m_fileListConnection = connect(project, &Project::fileListChanged, this, [this, project]() {
+        m_tool->projectSearch()->setProjectFiles(DeepSeekProjectGenerator::projectFiles(project));
+    });
+    if (project->rootProjectNode())
+        m_tool->projectSearch()->setProjectFiles(DeepSeekProjectGenerator::projectFiles(project));
+}
+
 void DeepSeekPlugin::showWidget()
 {
     if (m_widget) {
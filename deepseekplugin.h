@@ -5,6 +5,7 @@
 #include "deepseektool.h"
 #include "deepseekprojectgenerator.h"
 #include "deepseekcodeeditor.h"
+#include "deepseekinlinecompletion.h"
 
 namespace DeepSeekAI {
 namespace Internal {
@@ -31,11 +32,16 @@ private slots:
 private:
     void initializeMenu();
     void setupConnections();
+    // Mantiene el índice de búsqueda sobre el proyecto de arranque
+    void indexProject(ProjectExplorer::Project *project);
 
     DeepSeekTool *m_tool = nullptr;
     DeepSeekProjectGenerator *m_projectGenerator = nullptr;
     DeepSeekWidget *m_widget = nullptr;
     DeepSeekCodeEditor *m_codeEditor = nullptr;
+    DeepSeekInlineCompletion *m_inlineCompletion = nullptr;
+    QMetaObject::Connection m_parsingConnection;
+    QMetaObject::Connection m_fileListConnection;
 };
 
 } // namespace Internal
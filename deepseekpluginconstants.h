@@ -5,5 +5,14 @@ namespace DeepSeekAI::Constants {
 const char ACTION_ID[] = "DeepSeekPlugin.Action";
 const char SETTINGS_ACTION_ID[] = "DeepSeekPlugin.SettingsAction"; // Nueva constante
 const char MENU_ID[] = "DeepSeekPlugin.Menu";
+const char PIN_FILE_ACTION_ID[] = "DeepSeekPlugin.PinFileAction";
+
+// Modo de las peticiones intermedias del análisis de proyecto (map-reduce)
+const char ANALYSIS_CHUNK_MODE[] = "analysis-chunk";
+// Corrección limitada a la selección o a la función del cursor
+const char SCOPED_FIX_MODE[] = "fix-scope";
+// Completado en línea (fill-in-the-middle) mientras se escribe
+const char INLINE_COMPLETION_MODE[] = "inline-completion";
+const char INLINE_COMPLETION_ACTION_ID[] = "DeepSeekPlugin.InlineCompletionAction";
 
 } // namespace Internal::Constants
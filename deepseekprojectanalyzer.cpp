@@ -0,0 +1,553 @@
+#include "deepseekprojectanalyzer.h"
+#include "deepseekcodechunker.h"
+#include "deepseekpluginconstants.h"
+#include "deepseektokenestimator.h"
+#include "deepseektool.h"
+
+#include "messagehelper.h"
+
+#include <coreplugin/icore.h>
+
+#include <QCryptographicHash>
+
+#include <utility>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Respuesta máxima de cada paso intermedio; acota también lo que ocupa la fusión
+const int kStepMaxTokens = 1000;
+// Instrucciones que envuelven cada fragmento
+const int kPromptOverheadTokens = 200;
+
+const char kStepSystemPrompt[] =
+    "You review parts of a Qt/C++ project. Be concise and factual, cite the file for each "
+    "point and do not repeat code.";
+
+// Corta por líneas un texto que no cabe en una parte
+void splitByLines(QStringView text, int partBudget, QStringList *parts)
+{
+    QString part;
+    int partTokens = 0;
+    if (text.endsWith('\n'))
+        text.chop(1);
+    for (QStringView line : text.split('\n')) {
+        int lineTokens = DeepSeekTokenEstimator::estimate(line) + 1;
+        while (lineTokens > partBudget) {
+            // Línea desmesurada (datos embebidos, código minificado)
+            const qsizetype cut = qMax<qsizetype>(
+                1, DeepSeekTokenEstimator::truncatedLength(line, partBudget - 1));
+            if (!part.isEmpty())
+                parts->append(part);
+            parts->append(line.left(cut).toString() + '\n');
+            part.clear();
+            partTokens = 0;
+            line = line.mid(cut);
+            lineTokens = DeepSeekTokenEstimator::estimate(line) + 1;
+        }
+        if (partTokens + lineTokens > partBudget && !part.isEmpty()) {
+            parts->append(part);
+            part.clear();
+            partTokens = 0;
+        }
+        part += line;
+        part += '\n';
+        partTokens += lineTokens;
+    }
+    if (!part.isEmpty())
+        parts->append(part);
+}
+
+} // namespace
+
+DeepSeekProjectAnalyzer::DeepSeekProjectAnalyzer(DeepSeekTool *tool, QObject *parent)
+    : QObject(parent),
+      m_tool(tool),
+      m_ingestor(new DeepSeekFileIngestor(this))
+{
+    connect(m_ingestor, &DeepSeekFileIngestor::filesReady,
+            this, &DeepSeekProjectAnalyzer::addFiles);
+    connect(m_ingestor, &DeepSeekFileIngestor::finished,
+            this, &DeepSeekProjectAnalyzer::onIngestionFinished);
+}
+
+void DeepSeekProjectAnalyzer::setChunkTokenBudget(int tokens)
+{
+    // La fusión final lleva además la lista de archivos (hasta un cuarto del
+    // presupuesto) y su respuesta: con la mitad del contexto siempre cabe
+    m_chunkTokens = qBound(4000, tokens, DeepSeekTokenEstimator::ContextTokens / 2);
+}
+
+bool DeepSeekProjectAnalyzer::start(const QString &projectFilePath, const QStringList &paths)
+{
+    if (!begin())
+        return false;
+
+    QElapsedTimer planTimer;
+    planTimer.start();
+    m_index.load(indexPathFor(projectFilePath));
+    const DeepSeekProjectIndex::Plan plan = m_index.plan(paths);
+    for (const auto &[path, mtimeMs] : plan.touched.asKeyValueRange())
+        m_index.setFileTime(path, mtimeMs);
+
+    m_useIndex = true;
+    m_files = paths;
+    m_projectPaths = QSet<QString>(paths.cbegin(), paths.cend());
+    for (const QString &findings : plan.reusedFindings)
+        addFinishedChunk(0, findings);
+
+    Utils::MessageHelper::showMessage(
+        tr("Índice del proyecto: %1 archivos sin cambios (%2 fragmentos), %3 por leer (%4 ms)")
+            .arg(plan.reusedFiles).arg(plan.reusedFindings.size())
+            .arg(plan.toRead.size()).arg(planTimer.elapsed()),
+        Utils::MessageHelper::Silent
+        );
+
+    m_ingestor->start(plan.toRead);
+    return true;
+}
+
+bool DeepSeekProjectAnalyzer::begin()
+{
+    if (m_running)
+        return false;
+
+    m_running = true;
+    m_acceptingInput = true;
+    m_stage = 0;
+    m_files.clear();
+    m_chunk.clear();
+    m_chunkUsedTokens = 0;
+    m_chunkPaths.clear();
+    m_useIndex = false;
+    m_projectPaths.clear();
+    m_readEntries.clear();
+    m_promptKeys.clear();
+    m_reusedChunks = 0;
+    m_timer.start();
+    runStage({});
+
+    emit chunkProgress(0, 0);
+    emit progressChanged(10);
+    return true;
+}
+
+void DeepSeekProjectAnalyzer::addFiles(const QList<IngestedFile> &files)
+{
+    if (!m_acceptingInput)
+        return;
+
+    for (const IngestedFile &file : files) {
+        if (m_useIndex) {
+            DeepSeekProjectIndex::FileEntry entry;
+            entry.size = file.content.size();
+            entry.mtimeMs = file.mtimeMs;
+            entry.hash = file.hash;
+            m_readEntries.insert(file.path, entry);
+        } else {
+            m_files.append(file.path);
+        }
+        packFile(file.path, file.content);
+    }
+    dispatch();
+}
+
+void DeepSeekProjectAnalyzer::finishInput()
+{
+    if (!m_acceptingInput)
+        return;
+
+    m_acceptingInput = false;
+    flushChunk();
+    m_files.sort();
+
+    if (m_useIndex) {
+        for (const auto &[path, entry] : m_readEntries.asKeyValueRange())
+            m_index.setFile(path, entry);
+        m_readEntries.clear();
+        m_index.retain(m_projectPaths);
+    }
+
+    if (m_prompts.isEmpty()) {
+        stop();
+        emit failed(tr("El proyecto no contiene archivos que analizar"));
+        return;
+    }
+
+    Utils::MessageHelper::showMessage(
+        tr("Análisis de proyecto: %1 archivos en %2 fragmentos, %3 ya analizados (%4 en paralelo)")
+            .arg(m_files.size()).arg(m_prompts.size()).arg(m_reusedChunks).arg(m_maxParallel),
+        Utils::MessageHelper::Silent
+        );
+
+    reportChunkProgress();
+    if (m_doneCount == m_prompts.size())
+        finishStage();
+    else
+        dispatch();
+}
+
+void DeepSeekProjectAnalyzer::cancel()
+{
+    if (!m_running)
+        return;
+
+    stop();
+    emit progressChanged(0);
+}
+
+void DeepSeekProjectAnalyzer::packFile(const QString &path, QByteArrayView content)
+{
+    const QString text = QString::fromUtf8(content);
+    if (text.trimmed().isEmpty())
+        return;
+
+    const int budget = m_chunkTokens - kPromptOverheadTokens;
+    const QString header = QString("\n==== %1 ====\n").arg(path);
+    const int tokens = DeepSeekTokenEstimator::estimate(header)
+                       + DeepSeekTokenEstimator::estimate(text);
+    if (tokens <= budget) {
+        appendToChunk(path, header + text + '\n', tokens);
+        return;
+    }
+
+    // Fichero más grande que un fragmento: se reparte en partes de clases y
+    // funciones completas; solo una unidad que no cabe sola se corta por líneas
+    const int partBudget = budget - DeepSeekTokenEstimator::estimate(header) - 8;
+    QStringList parts;
+    QString part;
+    int partTokens = 0;
+    const QList<DeepSeekCodeChunker::Unit> units
+        = DeepSeekCodeChunker::split(content, DeepSeekCodeChunker::languageFor(path));
+    for (const DeepSeekCodeChunker::Unit &unit : units) {
+        const QString unitText = QString::fromUtf8(content.sliced(unit.begin, unit.end - unit.begin));
+        if (partTokens + unit.tokens > partBudget && !part.isEmpty()) {
+            parts.append(part);
+            part.clear();
+            partTokens = 0;
+        }
+        if (unit.tokens > partBudget) {
+            splitByLines(unitText, partBudget, &parts);
+            continue;
+        }
+        part += unitText;
+        partTokens += unit.tokens;
+    }
+    if (!part.isEmpty())
+        parts.append(part);
+
+    for (int i = 0; i < parts.size(); ++i) {
+        const QString partHeader = QString("\n==== %1 (part %2/%3) ====\n")
+                                       .arg(path).arg(i + 1).arg(parts.size());
+        appendToChunk(path, partHeader + parts.at(i),
+                      DeepSeekTokenEstimator::estimate(partHeader)
+                          + DeepSeekTokenEstimator::estimate(parts.at(i)));
+    }
+}
+
+void DeepSeekProjectAnalyzer::appendToChunk(const QString &path, const QString &piece, int tokens)
+{
+    if (m_chunkUsedTokens + tokens > m_chunkTokens - kPromptOverheadTokens)
+        flushChunk();
+    m_chunk += piece;
+    m_chunkUsedTokens += tokens;
+    if (m_chunkPaths.isEmpty() || m_chunkPaths.last() != path)
+        m_chunkPaths.append(path);
+}
+
+void DeepSeekProjectAnalyzer::flushChunk()
+{
+    if (m_chunk.isEmpty())
+        return;
+
+    // Misma clave si el texto del fragmento no cambió, aunque sus ficheros
+    // se hayan tocado (checkout, touch)
+    const quint64 key = m_useIndex ? DeepSeekProjectIndex::chunkKey(m_chunk) : 0;
+    for (const QString &path : std::as_const(m_chunkPaths)) {
+        const auto it = m_readEntries.find(path);
+        if (it != m_readEntries.end())
+            it->chunks.append(key);
+    }
+    const QString known = m_useIndex ? m_index.chunkResult(key) : QString();
+
+    if (!known.isEmpty()) {
+        addFinishedChunk(key, known);
+    } else {
+        // Instrucciones idénticas en todas las partes y el código detrás: todas
+        // las peticiones comparten prefijo en la caché de contexto de DeepSeek
+        m_prompts.append(QString("Analyze this part of a Qt project and list:\n"
+                                 "1. Architecture issues\n"
+                                 "2. Performance problems\n"
+                                 "3. Outdated Qt practices\n"
+                                 "4. Potential bugs\n\n%1")
+                             .arg(m_chunk));
+        m_results.append(QString());
+        m_promptKeys.append(key);
+    }
+
+    m_chunk.clear();
+    m_chunkUsedTokens = 0;
+    m_chunkPaths.clear();
+}
+
+void DeepSeekProjectAnalyzer::addFinishedChunk(quint64 key, const QString &findings)
+{
+    m_prompts.append(QString());
+    m_results.append(findings);
+    m_promptKeys.append(key);
+    ++m_doneCount;
+    ++m_reusedChunks;
+}
+
+void DeepSeekProjectAnalyzer::onIngestionFinished(const DeepSeekFileIngestor::Stats &stats)
+{
+    Utils::MessageHelper::showMessage(
+        tr("Proyecto leído: %1 archivos (%2 MB) en %3 ms, %4 archivos/s, %5 MB/s%6%7")
+            .arg(stats.files)
+            .arg(stats.bytes / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(stats.elapsedMs)
+            .arg(stats.filesPerSecond(), 0, 'f', 0)
+            .arg(stats.bytesPerSecond() / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(stats.failed > 0 ? tr(", %1 sin leer").arg(stats.failed) : QString())
+            .arg(stats.skipped > 0
+                     ? tr(", %1 descartados (binarios, generados o grandes; %2 MB sin leer)")
+                           .arg(stats.skipped)
+                           .arg(stats.skippedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                     : QString()),
+        Utils::MessageHelper::Silent
+        );
+    finishInput();
+}
+
+void DeepSeekProjectAnalyzer::saveIndex()
+{
+    if (!m_useIndex)
+        return;
+
+    if (!m_index.save()) {
+        Utils::MessageHelper::showMessage(
+            tr("No se pudo guardar el índice del proyecto"),
+            Utils::MessageHelper::Silent
+            );
+    }
+}
+
+QString DeepSeekProjectAnalyzer::indexPathFor(const QString &projectFilePath)
+{
+    // Junto a los datos de sesión de Qt Creator, un fichero por proyecto
+    const QByteArray id = QCryptographicHash::hash(projectFilePath.toUtf8(),
+                                                   QCryptographicHash::Sha1).toHex();
+    return Core::ICore::userResourcePath("deepseek/index")
+        .pathAppended(QString::fromLatin1(id) + ".idx").toString();
+}
+
+QStringList DeepSeekProjectAnalyzer::buildMergePrompts(const QStringList &findings) const
+{
+    const int budget = m_chunkTokens - kPromptOverheadTokens;
+
+    QList<QStringList> groups(1);
+    int groupTokens = 0;
+    for (const QString &finding : findings) {
+        const int tokens = DeepSeekTokenEstimator::estimate(finding) + 4;
+        if (groupTokens + tokens > budget && !groups.last().isEmpty()) {
+            groups.append(QStringList());
+            groupTokens = 0;
+        }
+        groups.last().append(finding);
+        groupTokens += tokens;
+    }
+
+    if (groups.size() == 1)
+        return {};
+
+    QStringList prompts;
+    for (const QStringList &group : std::as_const(groups)) {
+        prompts.append("Merge these partial reviews of the same Qt project into a single list, "
+                       "removing duplicates and keeping the file references:\n\n"
+                       + group.join("\n\n---\n\n"));
+    }
+    return prompts;
+}
+
+QString DeepSeekProjectAnalyzer::buildFinalPrompt(const QStringList &findings) const
+{
+    QString prompt = "Analyze this Qt project and provide:\n";
+    prompt += "1. Architecture suggestions\n";
+    prompt += "2. Performance improvements\n";
+    prompt += "3. Modern Qt practices to apply\n";
+    prompt += "4. Potential bugs\n\n";
+    prompt += "Use a markdown heading for each section.\n\n";
+    prompt += "Project structure:\n";
+
+    // La lista de archivos no debe comerse el espacio de los resultados
+    const int listBudget = m_chunkTokens / 4;
+    int listTokens = 0;
+    for (int i = 0; i < m_files.size(); ++i) {
+        const QString line = "- " + m_files.at(i) + "\n";
+        listTokens += DeepSeekTokenEstimator::estimate(line);
+        if (listTokens > listBudget) {
+            prompt += QString("- ... %1 more files\n").arg(m_files.size() - i);
+            break;
+        }
+        prompt += line;
+    }
+
+    prompt += "\nFindings from each part of the project:\n\n";
+    prompt += findings.join("\n\n---\n\n");
+    return prompt;
+}
+
+void DeepSeekProjectAnalyzer::runStage(const QStringList &prompts)
+{
+    m_prompts = prompts;
+    m_results = QStringList(prompts.size(), QString());
+    m_nextPrompt = 0;
+    m_doneCount = 0;
+    m_failedCount = 0;
+    dispatch();
+}
+
+void DeepSeekProjectAnalyzer::reportChunkProgress()
+{
+    emit chunkProgress(m_doneCount, m_prompts.size());
+    if (!m_prompts.isEmpty())
+        emit progressChanged(10 + 70 * m_doneCount / m_prompts.size());
+}
+
+void DeepSeekProjectAnalyzer::dispatch()
+{
+    m_inFlight.removeIf([](const QPointer<DeepSeekRequest> &handle) {
+        return !handle || !handle->isActive();
+    });
+
+    while (m_running && m_nextPrompt < m_prompts.size() && m_inFlight.size() < m_maxParallel) {
+        const int index = m_nextPrompt++;
+        if (m_prompts.at(index).isEmpty())
+            continue;
+
+        ChatCompletionRequest chat;
+        chat.messages.append({"system", kStepSystemPrompt});
+        chat.messages.append({"user", m_prompts.at(index)});
+        // Deterministas: los fragmentos sin cambios salen de la caché de respuestas
+        chat.temperature = 0.0;
+        chat.maxTokens = kStepMaxTokens;
+
+        DeepSeekRequest *handle = m_tool->submitRequest(chat, Constants::ANALYSIS_CHUNK_MODE);
+        if (!handle) {
+            // DeepSeekTool ya informó del motivo (p.ej. falta la API Key)
+            stop();
+            emit failed(tr("No se pudo enviar el análisis del proyecto"));
+            return;
+        }
+
+        m_inFlight.append(handle);
+        connect(handle, &DeepSeekRequest::finished, this, [this, index](const QString &content) {
+            onStepDone(index, content, true);
+        });
+        connect(handle, &DeepSeekRequest::failed, this, [this, index]() {
+            onStepDone(index, QString(), false);
+        });
+        connect(handle, &DeepSeekRequest::cancelled, this, [this]() {
+            if (m_running)
+                cancel();
+        });
+    }
+}
+
+void DeepSeekProjectAnalyzer::onStepDone(int index, const QString &result, bool ok)
+{
+    if (!m_running)
+        return;
+
+    m_results[index] = result.trimmed();
+    ++m_doneCount;
+    if (!ok)
+        ++m_failedCount;
+
+    if (m_stage == 0) {
+        if (m_useIndex && ok)
+            m_index.setChunkResult(m_promptKeys.at(index), m_results.at(index));
+        reportChunkProgress();
+        Utils::MessageHelper::showMessage(
+            tr("Análisis de proyecto: fragmento %1 %2")
+                .arg(index + 1).arg(ok ? tr("listo") : tr("sin resultado")),
+            Utils::MessageHelper::Silent
+            );
+    }
+
+    // Mientras se leen ficheros pueden llegar más fragmentos
+    if (m_doneCount == m_prompts.size() && !m_acceptingInput)
+        finishStage();
+    else
+        dispatch();
+}
+
+void DeepSeekProjectAnalyzer::finishStage()
+{
+    if (m_stage == 0)
+        saveIndex();
+
+    QStringList findings;
+    for (const QString &result : std::as_const(m_results)) {
+        if (!result.isEmpty())
+            findings.append(result);
+    }
+
+    if (findings.isEmpty()) {
+        stop();
+        emit failed(tr("Ninguna parte del proyecto pudo analizarse"));
+        return;
+    }
+
+    if (m_failedCount > 0) {
+        const int sent = int(m_prompts.size()) - (m_stage == 0 ? m_reusedChunks : 0);
+        Utils::MessageHelper::showMessage(
+            tr("Análisis de proyecto: %1 de %2 peticiones fallaron, se continúa con el resto")
+                .arg(m_failedCount).arg(sent),
+            Utils::MessageHelper::Flash
+            );
+    }
+
+    // Si los resultados no caben en una sola petición se fusionan por grupos
+    const QStringList merges = buildMergePrompts(findings);
+    if (!merges.isEmpty()) {
+        ++m_stage;
+        emit progressChanged(85);
+        runStage(merges);
+        return;
+    }
+
+    m_running = false;
+    m_inFlight.clear();
+    Utils::MessageHelper::showMessage(
+        tr("Análisis de proyecto: fragmentos completados en %1 ms, fusionando resultados")
+            .arg(m_timer.elapsed()),
+        Utils::MessageHelper::Silent
+        );
+    emit progressChanged(90);
+    // Sin sendRequest(): el prompt ya resume todo el proyecto y no necesita
+    // fragmentos recuperados
+    ChatCompletionRequest chat;
+    chat.messages.append({"user", buildFinalPrompt(findings)});
+    chat.temperature = 0.7;
+    chat.maxTokens = 2000;
+    m_tool->submitRequest(chat, "analysis");
+}
+
+void DeepSeekProjectAnalyzer::stop()
+{
+    m_running = false;
+    m_acceptingInput = false;
+    m_chunk.clear();
+    m_ingestor->cancel();
+    const QList<QPointer<DeepSeekRequest>> handles = std::exchange(m_inFlight, {});
+    for (const QPointer<DeepSeekRequest> &handle : handles) {
+        if (handle)
+            handle->cancel();
+    }
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "deepseekfileingestor.h"
+#include "deepseekprojectindex.h"
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QElapsedTimer>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+class DeepSeekTool;
+class DeepSeekRequest;
+
+// Análisis de proyecto en modo map-reduce.
+//
+// Los ficheros llegan por lotes (addFiles) a medida que se leen y se
+// empaquetan en fragmentos de un presupuesto de tokens fijo (los grandes
+// se cortan por clases y funciones); cada fragmento se analiza en una
+// petición propia en cuanto se llena, con como mucho maxParallelChunks
+// en vuelo. Si los resultados parciales no caben juntos en una petición
+// se fusionan por grupos, también en paralelo, hasta que caben; la
+// fusión final se envía en modo "analysis" y termina en
+// DeepSeekTool::projectAnalysisReady.
+//
+// start() trabaja de forma incremental con un DeepSeekProjectIndex por
+// proyecto: solo se leen los ficheros que cambiaron (o comparten fragmento
+// con uno que cambió) y los fragmentos cuyo texto ya se analizó reutilizan
+// el resultado guardado sin enviar petición.
+class DeepSeekProjectAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeepSeekProjectAnalyzer(DeepSeekTool *tool, QObject *parent = nullptr);
+
+    void setChunkTokenBudget(int tokens);
+    int chunkTokenBudget() const { return m_chunkTokens; }
+    void setMaxParallelChunks(int count) { m_maxParallel = qMax(1, count); }
+    int maxParallelChunks() const { return m_maxParallel; }
+
+    bool isRunning() const { return m_running; }
+
+    // Lee y analiza los ficheros del proyecto usando su índice. Devuelve
+    // false si ya hay un análisis en curso
+    bool start(const QString &projectFilePath, const QStringList &paths);
+
+    // Análisis sin índice. Devuelve false si ya hay uno en curso. Tras begin() se
+    // entregan los ficheros con addFiles() y finishInput() cierra la entrada
+    bool begin();
+    void addFiles(const QList<DeepSeekAI::Internal::IngestedFile> &files);
+    void finishInput();
+    void cancel();
+
+signals:
+    void chunkProgress(int finishedChunks, int totalChunks);
+    void progressChanged(int progress);
+    void failed(const QString &error);
+
+private:
+    void packFile(const QString &path, QByteArrayView content);
+    void appendToChunk(const QString &path, const QString &piece, int tokens);
+    void flushChunk();
+    void addFinishedChunk(quint64 key, const QString &findings);
+    void onIngestionFinished(const DeepSeekFileIngestor::Stats &stats);
+    void saveIndex();
+    static QString indexPathFor(const QString &projectFilePath);
+    QStringList buildMergePrompts(const QStringList &findings) const;
+    QString buildFinalPrompt(const QStringList &findings) const;
+
+    void runStage(const QStringList &prompts);
+    void reportChunkProgress();
+    void dispatch();
+    void onStepDone(int index, const QString &result, bool ok);
+    void finishStage();
+    void stop();
+
+    DeepSeekTool *m_tool;
+    int m_chunkTokens = 12000;
+    int m_maxParallel = 4;
+
+    bool m_running = false;
+    bool m_acceptingInput = false;
+    int m_stage = 0;
+    QStringList m_files;
+    QString m_chunk;          // fragmento en construcción
+    int m_chunkUsedTokens = 0;
+    QStringList m_chunkPaths; // ficheros que forman m_chunk
+    QStringList m_prompts;    // vacío: fragmento ya resuelto desde el índice
+    QStringList m_results;
+    int m_nextPrompt = 0;
+    int m_doneCount = 0;
+    int m_failedCount = 0;
+    QList<QPointer<DeepSeekRequest>> m_inFlight;
+    QElapsedTimer m_timer;
+
+    DeepSeekFileIngestor *m_ingestor;
+    DeepSeekProjectIndex m_index;
+    bool m_useIndex = false;
+    QSet<QString> m_projectPaths;
+    QHash<QString, DeepSeekProjectIndex::FileEntry> m_readEntries;
+    QList<quint64> m_promptKeys;   // clave de cada fragmento de la etapa 0
+    int m_reusedChunks = 0;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -1,6 +1,7 @@
 #include "deepseekprojectgenerator.h"
 #include "deepseekpluginconstants.h"
 
+#include <projectexplorer/buildsystem.h>
 #include <projectexplorer/projectexplorer.h>
 #include <projectexplorer/projecttree.h>
 #include <projectexplorer/projectmanager.h>
@@ -20,7 +21,6 @@
 #include <QMessageBox>
 #include <QTextStream>
 #include <QDateTime>
-#include <QFutureWatcher>
 
 using namespace ProjectExplorer;
 using namespace Utils;
@@ -113,70 +113,74 @@ void DeepSeekProjectGenerator::generateProject(const QString &projectName,
 
 void DeepSeekProjectGenerator::openAndAnalyzeProject(const QString &projectFilePath)
 {
-    FilePath filePath = FilePath::fromString(projectFilePath);
+    // El árbol del proyecto pertenece al hilo de la GUI: se abre aquí y se
+    // espera a que termine de cargarse sin bloquear
+    OpenProjectResult result = ProjectExplorerPlugin::openProject(FilePath::fromString(projectFilePath));
+    if (!result) {
+        emit errorOccurred(tr("Failed to open project: %1").arg(result.errorMessage()));
+        return;
+    }
 
-    // Solución correcta - obtener el thread pool primero
-    QThreadPool* pool = QThreadPool::globalInstance();
-    auto future = QtConcurrent::run(pool, [this, filePath]() {
-        OpenProjectResult result = ProjectExplorerPlugin::instance()->openProject(filePath);
+    Project *project = result.project();
+    if (!project) {
+        emit errorOccurred(tr("Project opened but invalid"));
+        return;
+    }
 
-        if (!result) {
-            emit errorOccurred(tr("Failed to open project: %1").arg(result.errorMessage()));
-            return;
-        }
+    ProjectExplorer::BuildSystem *buildSystem = project->activeBuildSystem();
+    if (project->rootProjectNode() && !(buildSystem && buildSystem->isParsing())) {
+        collectProjectFiles(project);
+        return;
+    }
 
-        Project* project = result.project();
-        if (!project) {
-            emit errorOccurred(tr("Project opened but invalid"));
+    // Sin plazo fijo: un proyecto CMake grande puede tardar lo que haga falta
+    connect(project, &Project::anyParsingFinished, this, [this, project](bool success) {
+        if (!success && !project->rootProjectNode()) {
+            emit errorOccurred(tr("Project could not be parsed: %1")
+                                   .arg(project->projectFilePath().toUserOutput()));
             return;
         }
+        collectProjectFiles(project);
+    }, Qt::SingleShotConnection);
+}
 
-        // Espera activa mejorada
-        QElapsedTimer timer;
-        timer.start();
-        while (!project->rootProjectNode() && timer.elapsed() < 5000) {
-            QThread::msleep(100);
-            QCoreApplication::processEvents();
+QStringList DeepSeekProjectGenerator::projectFiles(Project *project)
+{
+    QStringList paths;
+    ProjectNode *rootNode = project ? project->rootProjectNode() : nullptr;
+    if (!rootNode)
+        return paths;
+
+    // Resource incluye imágenes y fuentes; el ingestor las descarta sin
+    // leerlas (DeepSeekFileClassifier), pero .qrc, .json o .ui sí interesan
+    rootNode->forEachNode([&paths](FileNode *node) {
+        if (node &&
+            (node->fileType() == FileType::Source ||
+             node->fileType() == FileType::Header ||
+             node->fileType() == FileType::QML ||
+             node->fileType() == FileType::Resource)) {
+            paths.append(node->filePath().toUserOutput());
         }
+        return true;
+    });
+    // Ordenadas, los lotes agrupan ficheros del mismo directorio
+    paths.sort();
+    return paths;
+}
 
-        if (!project->rootProjectNode()) {
-            emit errorOccurred(tr("Project structure not loaded after timeout"));
-            return;
-        }
+void DeepSeekProjectGenerator::collectProjectFiles(Project *project)
+{
+    ProjectNode *rootNode = project->rootProjectNode();
+    if (!rootNode) {
+        emit errorOccurred(tr("Project structure not loaded"));
+        return;
+    }
 
-        emit projectOpened(project);
-
-        QMap<QString, QString> projectContents;
-        ProjectNode *rootNode = project->rootProjectNode();
-
-        auto processFile = [&projectContents](const FilePath &filePath) {
-            QFile file(filePath.toUserOutput());
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream stream(&file);
-                projectContents.insert(filePath.toUserOutput(), stream.readAll());
-                file.close();
-                return true;
-            }
-            return false;
-        };
-
-        rootNode->forEachNode([&](FileNode *node) {
-            if (node &&
-                (node->fileType() == FileType::Source ||
-                 node->fileType() == FileType::Header ||
-                 node->fileType() == FileType::QML ||
-                 node->fileType() == FileType::Resource)) {
-                processFile(node->filePath());
-            }
-            return true;
-        });
-
-        emit projectAnalysisComplete(projectContents);
-    });
+    emit projectOpened(project);
 
-    auto *watcher = new QFutureWatcher<void>(this);
-    connect(watcher, &QFutureWatcher<void>::finished, watcher, &QFutureWatcher<void>::deleteLater);
-    watcher->setFuture(future);
+    // Aquí solo se recogen las rutas; la lectura la decide el análisis
+    const QStringList paths = projectFiles(project);
+    emit projectFilesCollected(project->projectFilePath().toUserOutput(), paths);
 }
 
 void DeepSeekProjectGenerator::createProjectStructure(const QString &projectPath, const QString &projectType)
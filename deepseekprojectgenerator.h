@@ -38,15 +38,17 @@ public:
                          const QString &prompt);
 
     void openAndAnalyzeProject(const QString &projectFilePath);
-    void optimizeProjectStructure(const QMap<QString, QString> &projectContents);
 
     static QStringList availableProjectTypes();
     static QStringList availableBuildSystems();
+    // Fuentes, cabeceras, QML y recursos del proyecto, ordenados por ruta
+    static QStringList projectFiles(ProjectExplorer::Project *project);
 
 signals:
     void projectGenerated(const QString &projectPath);
     void projectOpened(ProjectExplorer::Project* project);
-    void projectAnalysisComplete(const QMap<QString, QString>& fileContents);
+    // Ficheros de un proyecto abierto que deben analizarse
+    void projectFilesCollected(const QString &projectFilePath, const QStringList &paths);
     void optimizationComplete(const QMap<QString, QString>& optimizedFiles);
     void errorOccurred(const QString &error);
 
@@ -65,7 +67,7 @@ private:
     void generateUiFile(const QString &filePath, const QString &formClass);
     void generateQrcFile(const QString &filePath);
     void generatePluginFiles(const QString &projectPath, const QString &pluginName);
-    void analyzeProjectNode(ProjectExplorer::ProjectNode *node, QMap<QString, QString> &contents);
+    void collectProjectFiles(ProjectExplorer::Project *project);
 };
 
 } // namespace Internal
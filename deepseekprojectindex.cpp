@@ -0,0 +1,322 @@
+#include "deepseekprojectindex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <utility>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Cabecera: magic, versión, nº ficheros, nº fragmentos
+const char kMagic[4] = {'D', 'S', 'P', '1'};
+const quint32 kVersion = 3;   // 3: vuelve el hash por fichero
+const int kHeaderSize = 16;
+
+template<typename T>
+void put(QByteArray *out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out->append(bytes, sizeof(T));
+}
+
+// Lectura con comprobación de límites: cualquier desbordamiento marca el
+// fichero como dañado
+class Reader
+{
+public:
+    explicit Reader(QByteArrayView data) : m_data(data) {}
+
+    template<typename T>
+    T get()
+    {
+        if (!require(sizeof(T)))
+            return T();
+        const T value = qFromLittleEndian<T>(m_data.data() + m_pos);
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    QByteArrayView bytes(qsizetype length)
+    {
+        if (!require(length))
+            return {};
+        const QByteArrayView view = m_data.mid(m_pos, length);
+        m_pos += length;
+        return view;
+    }
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos == m_data.size(); }
+
+private:
+    bool require(qsizetype length)
+    {
+        m_ok = m_ok && length >= 0 && m_data.size() - m_pos >= length;
+        return m_ok;
+    }
+
+    QByteArrayView m_data;
+    qsizetype m_pos = 0;
+    bool m_ok = true;
+};
+
+} // namespace
+
+quint64 DeepSeekProjectIndex::contentHash(QByteArrayView data)
+{
+    // MurmurHash64A: 8 bytes por paso, estable entre plataformas y versiones
+    // de Qt (qHash no lo es), suficiente para detectar cambios
+    const quint64 m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    quint64 h = 0x9e3779b97f4a7c15ULL ^ (quint64(data.size()) * m);
+    const char *p = data.data();
+    const char *const blocksEnd = p + (data.size() & ~qsizetype(7));
+
+    for (; p != blocksEnd; p += 8) {
+        quint64 k = qFromLittleEndian<quint64>(p);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    const int tail = int(data.size() & 7);
+    if (tail > 0) {
+        quint64 k = 0;
+        for (int i = tail - 1; i >= 0; --i)
+            k = (k << 8) | quint8(p[i]);
+        h ^= k;
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+quint64 DeepSeekProjectIndex::chunkKey(QStringView chunkText)
+{
+    return contentHash(QByteArrayView(reinterpret_cast<const char *>(chunkText.utf16()),
+                                      chunkText.size() * qsizetype(sizeof(char16_t))));
+}
+
+bool DeepSeekProjectIndex::load(const QString &filePath)
+{
+    clear();
+    m_filePath = filePath;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray data = file.readAll();
+
+    Reader reader(data);
+    const QByteArrayView magic = reader.bytes(4);
+    if (magic != QByteArrayView(kMagic, 4) || reader.get<quint32>() != kVersion)
+        return false;
+
+    const quint32 fileCount = reader.get<quint32>();
+    const quint32 chunkCount = reader.get<quint32>();
+    // Cada entrada ocupa al menos 28 bytes: no se reserva más de lo que cabe
+    m_files.reserve(qMin<qsizetype>(fileCount, data.size() / 28));
+
+    for (quint32 i = 0; i < fileCount && reader.ok(); ++i) {
+        const QString path = QString::fromUtf8(reader.bytes(reader.get<quint16>()));
+        FileEntry entry;
+        entry.size = reader.get<qint64>();
+        entry.mtimeMs = reader.get<qint64>();
+        entry.hash = reader.get<quint64>();
+        const quint16 chunks = reader.get<quint16>();
+        entry.chunks.reserve(chunks);
+        for (quint16 c = 0; c < chunks && reader.ok(); ++c)
+            entry.chunks.append(reader.get<quint64>());
+        m_files.insert(path, entry);
+    }
+
+    for (quint32 i = 0; i < chunkCount && reader.ok(); ++i) {
+        const quint64 key = reader.get<quint64>();
+        m_chunks.insert(key, QString::fromUtf8(reader.bytes(reader.get<quint32>())));
+    }
+
+    if (!reader.ok() || !reader.atEnd()) {
+        clear();
+        m_filePath = filePath;
+        return false;
+    }
+    return true;
+}
+
+bool DeepSeekProjectIndex::save() const
+{
+    if (m_filePath.isEmpty() || !QDir().mkpath(QFileInfo(m_filePath).absolutePath()))
+        return false;
+
+    QByteArray data;
+    data.reserve(kHeaderSize + m_files.size() * 96);
+    data.append(kMagic, 4);
+    put<quint32>(&data, kVersion);
+    put<quint32>(&data, quint32(m_files.size()));
+    put<quint32>(&data, quint32(m_chunks.size()));
+
+    for (const auto &[path, entry] : m_files.asKeyValueRange()) {
+        const QByteArray utf8 = path.toUtf8().left(0xffff);
+        put<quint16>(&data, quint16(utf8.size()));
+        data.append(utf8);
+        put<qint64>(&data, entry.size);
+        put<qint64>(&data, entry.mtimeMs);
+        put<quint64>(&data, entry.hash);
+        const qsizetype chunks = qMin<qsizetype>(entry.chunks.size(), 0xffff);
+        put<quint16>(&data, quint16(chunks));
+        for (qsizetype c = 0; c < chunks; ++c)
+            put<quint64>(&data, entry.chunks.at(c));
+    }
+
+    for (const auto &[key, result] : m_chunks.asKeyValueRange()) {
+        const QByteArray utf8 = result.toUtf8();
+        put<quint64>(&data, key);
+        put<quint32>(&data, quint32(utf8.size()));
+        data.append(utf8);
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(data);
+    return file.commit();
+}
+
+void DeepSeekProjectIndex::clear()
+{
+    m_filePath.clear();
+    m_files.clear();
+    m_chunks.clear();
+}
+
+DeepSeekProjectIndex::Plan DeepSeekProjectIndex::plan(const QStringList &paths) const
+{
+    Plan plan;
+    if (m_files.isEmpty()) {
+        plan.toRead = paths;
+        return plan;
+    }
+
+    // 1. Ficheros que un stat da por iguales; con el mismo tamaño y otra
+    //    fecha decide el hash, así un touch o un checkout no los reenvía
+    QSet<QString> unchanged;
+    for (const QString &path : paths) {
+        const auto it = m_files.constFind(path);
+        if (it == m_files.cend())
+            continue;
+        const QFileInfo info(path);
+        if (info.size() != it->size)
+            continue;
+        const qint64 mtimeMs = info.lastModified().toMSecsSinceEpoch();
+        if (mtimeMs != it->mtimeMs) {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly) || contentHash(file.readAll()) != it->hash)
+                continue;
+            plan.touched.insert(path, mtimeMs);
+        }
+        unchanged.insert(path);
+    }
+
+    // 2. Un fragmento sigue valiendo si todos sus ficheros siguen iguales;
+    //    los ficheros borrados del proyecto también lo invalidan
+    QSet<quint64> broken;
+    for (const auto &[path, entry] : m_files.asKeyValueRange()) {
+        if (!unchanged.contains(path)) {
+            for (quint64 key : entry.chunks)
+                broken.insert(key);
+        }
+    }
+
+    // 3. Se reutiliza un fichero si todos sus fragmentos se reutilizan
+    QSet<quint64> reused;
+    for (const QString &path : paths) {
+        const FileEntry *entry = unchanged.contains(path) ? file(path) : nullptr;
+        bool intact = entry && !entry->chunks.isEmpty();
+        if (intact) {
+            for (quint64 key : entry->chunks) {
+                if (broken.contains(key) || !m_chunks.contains(key)) {
+                    intact = false;
+                    break;
+                }
+            }
+        }
+        if (!intact) {
+            plan.toRead.append(path);
+            continue;
+        }
+
+        ++plan.reusedFiles;
+        for (quint64 key : entry->chunks) {
+            if (!reused.contains(key)) {
+                reused.insert(key);
+                plan.reusedFindings.append(m_chunks.value(key));
+            }
+        }
+    }
+
+    return plan;
+}
+
+const DeepSeekProjectIndex::FileEntry *DeepSeekProjectIndex::file(const QString &path) const
+{
+    const auto it = m_files.constFind(path);
+    return it == m_files.cend() ? nullptr : &it.value();
+}
+
+void DeepSeekProjectIndex::setFile(const QString &path, const FileEntry &entry)
+{
+    m_files.insert(path, entry);
+}
+
+void DeepSeekProjectIndex::setFileTime(const QString &path, qint64 mtimeMs)
+{
+    const auto it = m_files.find(path);
+    if (it != m_files.end())
+        it->mtimeMs = mtimeMs;
+}
+
+void DeepSeekProjectIndex::setChunkResult(quint64 key, const QString &result)
+{
+    if (result.isEmpty())
+        m_chunks.remove(key);
+    else
+        m_chunks.insert(key, result);
+}
+
+void DeepSeekProjectIndex::retain(const QSet<QString> &paths)
+{
+    QSet<quint64> referenced;
+    for (auto it = m_files.begin(); it != m_files.end();) {
+        if (!paths.contains(it.key())) {
+            it = m_files.erase(it);
+            continue;
+        }
+        for (quint64 key : std::as_const(it->chunks))
+            referenced.insert(key);
+        ++it;
+    }
+
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        if (referenced.contains(it.key()))
+            ++it;
+        else
+            it = m_chunks.erase(it);
+    }
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
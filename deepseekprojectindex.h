@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Índice persistente de un proyecto para el análisis incremental.
+//
+// Por cada fichero guarda tamaño, fecha de modificación, un hash rápido del
+// contenido y los fragmentos de análisis en los que entró; por cada
+// fragmento (identificado por el hash de su texto) guarda el último
+// resultado. plan() decide con un simple stat qué fragmentos siguen
+// valiendo y qué ficheros hay que volver a leer; solo lee los que tienen
+// el mismo tamaño y otra fecha (touch, checkout), y si el hash coincide
+// los da por iguales.
+//
+// Se guarda en un único fichero binario que se lee entero de una vez.
+class DeepSeekProjectIndex
+{
+public:
+    struct FileEntry {
+        qint64 size = 0;
+        qint64 mtimeMs = 0;
+        quint64 hash = 0;
+        QList<quint64> chunks;
+    };
+
+    struct Plan {
+        QStringList toRead;           // nuevos, modificados o en un fragmento roto
+        QStringList reusedFindings;   // resultados de fragmentos intactos
+        int reusedFiles = 0;
+        QHash<QString, qint64> touched;  // mismo contenido, con su nueva fecha
+    };
+
+    static quint64 contentHash(QByteArrayView data);
+    static quint64 chunkKey(QStringView chunkText);
+
+    // Un fichero ausente o dañado deja el índice vacío; no es un error
+    bool load(const QString &filePath);
+    bool save() const;
+    void clear();
+
+    bool isEmpty() const { return m_files.isEmpty(); }
+    int fileCount() const { return int(m_files.size()); }
+    int chunkCount() const { return int(m_chunks.size()); }
+
+    Plan plan(const QStringList &paths) const;
+
+    const FileEntry *file(const QString &path) const;
+    void setFile(const QString &path, const FileEntry &entry);
+    void setFileTime(const QString &path, qint64 mtimeMs);
+
+    QString chunkResult(quint64 key) const { return m_chunks.value(key); }
+    void setChunkResult(quint64 key, const QString &result);
+
+    // Olvida los ficheros que ya no están y los resultados sin referencias
+    void retain(const QSet<QString> &paths);
+
+private:
+    QString m_filePath;
+    QHash<QString, FileEntry> m_files;
+    QHash<quint64, QString> m_chunks;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,297 @@
+#include "deepseekprojectsearch.h"
+#include "deepseekfileclassifier.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <iterator>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+using IndexPointer = std::shared_ptr<const DeepSeekSearchIndex>;
+
+namespace {
+
+// Silencio tras el último cambio antes de actualizar
+const int kUpdateDelayMs = 750;
+// Con cambios continuos, se actualiza igualmente pasado este tiempo
+const int kMaxUpdateDelayMs = 3000;
+
+} // namespace
+
+DeepSeekProjectSearch::DeepSeekProjectSearch(QObject *parent)
+    : QObject(parent),
+      m_ingestor(new DeepSeekFileIngestor(this))
+{
+    // La búsqueda no debe competir con la lectura del análisis ni con el editor
+    m_ingestor->setMaxThreads(2);
+    m_ingestor->setThreadPriority(QThread::LowPriority);
+    m_ingestor->setMaxFileSize(DeepSeekSearchIndex::MaxFileBytes);
+    m_pool.setMaxThreadCount(1);
+    m_pool.setThreadPriority(QThread::LowPriority);
+
+    m_updateTimer.setSingleShot(true);
+    connect(&m_updateTimer, &QTimer::timeout, this, &DeepSeekProjectSearch::startUpdate);
+
+    connect(m_ingestor, &DeepSeekFileIngestor::filesReady,
+            this, [this](const QList<IngestedFile> &files) {
+                if (!m_builder)
+                    return;
+                // Los grandes y binarios ya los descartó el ingestor
+                for (const IngestedFile &file : files)
+                    m_builder->addFile(file.path, file.content, file.mtimeMs);
+            });
+    connect(m_ingestor, &DeepSeekFileIngestor::finished,
+            this, [this](const DeepSeekFileIngestor::Stats &stats) {
+                m_ingestionStats = stats;
+                onIngestionFinished();
+            });
+}
+
+void DeepSeekProjectSearch::setProjectFiles(const QStringList &paths)
+{
+    // Con índice, o con el primero aún construyéndose, basta sincronizar
+    if (m_index || m_busy) {
+        m_projectFiles = paths;
+        m_syncPending = true;
+        scheduleUpdate();
+        return;
+    }
+    startBuild(paths);
+}
+
+void DeepSeekProjectSearch::updateFiles(const QStringList &paths)
+{
+    // Sin índice no hay nada que actualizar; si se está construyendo, los
+    // cambios se aplican al terminar
+    if (!m_index && !m_busy)
+        return;
+    for (const QString &path : paths)
+        m_changedFiles.insert(path);
+    scheduleUpdate();
+}
+
+void DeepSeekProjectSearch::clear()
+{
+    ++m_generation;
+    m_ingestor->cancel();
+    m_builder.reset();
+    m_updateTimer.stop();
+    m_changedFiles.clear();
+    m_projectFiles.clear();
+    m_syncPending = false;
+    m_busy = false;
+    m_updating = false;
+    if (m_index) {
+        m_index.reset();
+        emit indexCleared();
+    }
+}
+
+QList<DeepSeekSearchIndex::Hit> DeepSeekProjectSearch::search(QStringView query, int maxHits) const
+{
+    const IndexPointer index = m_index;
+    return index ? index->search(query, maxHits) : QList<DeepSeekSearchIndex::Hit>();
+}
+
+void DeepSeekProjectSearch::startBuild(const QStringList &paths)
+{
+    ++m_generation;
+    m_busy = true;
+    m_updating = false;
+    m_builder = std::make_shared<DeepSeekProjectSnapshot::Builder>();
+    m_builder->reserve(paths.size(), 0);
+    m_timer.start();
+    m_ingestor->start(paths);
+}
+
+void DeepSeekProjectSearch::scheduleUpdate()
+{
+    if (!m_updateTimer.isActive())
+        m_firstPendingChange.start();
+    // Cada cambio retrasa la actualización, pero no más allá del máximo
+    const qint64 remaining = kMaxUpdateDelayMs - m_firstPendingChange.elapsed();
+    m_updateTimer.start(int(qBound<qint64>(0, remaining, kUpdateDelayMs)));
+}
+
+void DeepSeekProjectSearch::startUpdate()
+{
+    if (m_busy || !m_index || (m_changedFiles.isEmpty() && !m_syncPending))
+        return;
+
+    m_busy = true;
+    m_timer.start();
+    const quint64 generation = m_generation;
+    const QStringList changed(m_changedFiles.cbegin(), m_changedFiles.cend());
+    QStringList projectFiles;
+    if (std::exchange(m_syncPending, false))
+        projectFiles = std::exchange(m_projectFiles, {});
+    m_changedFiles.clear();
+
+    // Miles de stat() no deben bloquear el hilo de la interfaz
+    auto future = QtConcurrent::run(&m_pool, &DeepSeekProjectSearch::planUpdate,
+                                    m_index, projectFiles, changed);
+    auto *watcher = new QFutureWatcher<UpdatePlan>(this);
+    connect(watcher, &QFutureWatcher<UpdatePlan>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation == m_generation)
+            onUpdatePlanned(watcher->result());
+    });
+    watcher->setFuture(future);
+}
+
+DeepSeekProjectSearch::UpdatePlan DeepSeekProjectSearch::planUpdate(
+    const IndexPointer &index, QStringList projectFiles, const QStringList &changedFiles)
+{
+    UpdatePlan plan;
+
+    // Se leen los ficheros cuyo tamaño o fecha no coinciden con lo indexado.
+    // Un guardado solo cuenta si el fichero ya es del índice: los nuevos
+    // llegan con la lista del proyecto
+    auto check = [&index, &plan](const QString &path, bool saved) {
+        qint64 size = 0;
+        qint64 mtimeMs = 0;
+        const bool indexed = index->fileState(path, &size, &mtimeMs);
+        if (saved && !indexed)
+            return;
+        const QFileInfo info(path);
+        if (!info.exists()) {
+            if (indexed)
+                plan.removed.append(path);
+            return;
+        }
+        if (indexed && !saved && size == info.size()
+            && mtimeMs == info.lastModified().toMSecsSinceEpoch()) {
+            return;
+        }
+        // Los que el ingestor descartaría sin leer ni se intentan
+        if (DeepSeekFileClassifier::classifyPath(path, info.size(), DeepSeekSearchIndex::MaxFileBytes)
+            == DeepSeekFileClassifier::Text)
+            plan.read.append(path);
+        else if (indexed)
+            plan.removed.append(path);
+    };
+
+    for (const QString &path : changedFiles)
+        check(path, true);
+
+    if (!projectFiles.isEmpty()) {
+        projectFiles.sort();
+        projectFiles.removeDuplicates();
+        const QSet<QString> changed(changedFiles.cbegin(), changedFiles.cend());
+        for (const QString &path : std::as_const(projectFiles)) {
+            if (!changed.contains(path))
+                check(path, false);
+        }
+
+        // Los que ya no son del proyecto: ambas listas en orden de cadena
+        const QStringList indexed = index->filePaths();
+        std::set_difference(indexed.cbegin(), indexed.cend(),
+                            projectFiles.cbegin(), projectFiles.cend(),
+                            std::back_inserter(plan.removed));
+    }
+    return plan;
+}
+
+void DeepSeekProjectSearch::onUpdatePlanned(const UpdatePlan &plan)
+{
+    if (plan.read.isEmpty() && plan.removed.isEmpty()) {
+        finishWork();
+        return;
+    }
+
+    m_updating = true;
+    m_updatePlan = plan;
+    m_builder = std::make_shared<DeepSeekProjectSnapshot::Builder>();
+    m_builder->reserve(plan.read.size(), 0);
+    // Sin ficheros que leer, finished() no llegaría: se aplica directamente
+    if (plan.read.isEmpty())
+        onIngestionFinished();
+    else
+        m_ingestor->start(plan.read);
+}
+
+void DeepSeekProjectSearch::onIngestionFinished()
+{
+    const quint64 generation = m_generation;
+    const std::shared_ptr<DeepSeekProjectSnapshot::Builder> builder = std::exchange(m_builder, {});
+    if (!builder)
+        return;
+
+    if (!m_updating) {
+        auto future = QtConcurrent::run([builder]() -> IndexPointer {
+            auto index = std::make_shared<DeepSeekSearchIndex>();
+            index->build(builder->build());
+            return index;
+        });
+
+        auto *watcher = new QFutureWatcher<IndexPointer>(this);
+        connect(watcher, &QFutureWatcher<IndexPointer>::finished, this, [this, watcher, generation]() {
+            watcher->deleteLater();
+            // Otro setProjectFiles() empezó mientras se construía
+            if (generation != m_generation)
+                return;
+            m_index = watcher->result();
+            emit indexReady(m_index->fileCount(), m_index->documentCount(), m_index->termCount(),
+                            m_timer.elapsed());
+            if (m_ingestionStats.skipped > 0)
+                emit filesSkipped(m_ingestionStats.skipped, m_ingestionStats.skippedBytes);
+            finishWork();
+        });
+        watcher->setFuture(future);
+        return;
+    }
+
+    const UpdatePlan plan = std::exchange(m_updatePlan, {});
+    const IndexPointer current = m_index;
+    auto future = QtConcurrent::run(&m_pool, [builder, plan, current]() {
+        UpdateResult result;
+        const DeepSeekProjectSnapshot::Pointer changes = builder->build();
+        // Los que no se pudieron leer o crecieron por encima del límite salen
+        QStringList removed = plan.removed;
+        for (const QString &path : plan.read) {
+            if (changes->indexOf(path) < 0)
+                removed.append(path);
+        }
+        result.changedFiles = changes->fileCount();
+        result.removedFiles = int(removed.size());
+
+        auto index = current->updated(changes, removed);
+        // Demasiados documentos muertos o capas: se reconstruye desde el
+        // contenido ya en memoria, sin volver a leer el disco
+        if (index->needsCompaction()) {
+            const DeepSeekProjectSnapshot::Pointer compacted = index->compactedSnapshot();
+            index = std::make_shared<DeepSeekSearchIndex>();
+            index->build(compacted);
+        }
+        result.index = index;
+        return result;
+    });
+
+    auto *watcher = new QFutureWatcher<UpdateResult>(this);
+    connect(watcher, &QFutureWatcher<UpdateResult>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_generation)
+            return;
+        const UpdateResult result = watcher->result();
+        m_index = result.index;
+        emit indexUpdated(result.changedFiles, result.removedFiles, m_timer.elapsed());
+        finishWork();
+    });
+    watcher->setFuture(future);
+}
+
+void DeepSeekProjectSearch::finishWork()
+{
+    m_busy = false;
+    m_updating = false;
+    if (!m_changedFiles.isEmpty() || m_syncPending)
+        scheduleUpdate();
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "deepseekfileingestor.h"
+#include "deepseeksearchindex.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <memory>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Mantiene un DeepSeekSearchIndex de los ficheros del proyecto activo.
+//
+// La primera vez, setProjectFiles() lee los ficheros con un
+// DeepSeekFileIngestor propio, copia cada lote al arena de un
+// DeepSeekProjectSnapshot según llega (el lote se libera enseguida) y
+// construye el índice en el pool global de hilos.
+//
+// Después el índice se mantiene en segundo plano: updateFiles() (ficheros
+// guardados) y nuevas llamadas a setProjectFiles() (cambios del árbol del
+// proyecto) se acumulan y se aplican juntos tras un rato sin cambios, así un
+// checkout que toca miles de ficheros es una sola actualización. Solo se
+// leen los ficheros cuyo tamaño o fecha no coinciden con lo indexado, y el
+// índice nuevo sale de DeepSeekSearchIndex::updated() en un hilo de baja
+// prioridad. En todos los casos el índice anterior sigue respondiendo hasta
+// que el nuevo está listo y se sustituye de golpe; es inmutable, así que
+// search() no necesita bloqueo.
+class DeepSeekProjectSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeepSeekProjectSearch(QObject *parent = nullptr);
+
+    void setProjectFiles(const QStringList &paths);
+    // Ficheros cambiados en disco (guardados, modificados fuera)
+    void updateFiles(const QStringList &paths);
+    void clear();
+
+    bool isReady() const { return bool(m_index); }
+    std::shared_ptr<const DeepSeekSearchIndex> index() const { return m_index; }
+
+    QList<DeepSeekSearchIndex::Hit> search(QStringView query, int maxHits) const;
+
+signals:
+    void indexReady(int files, int documents, int terms, qint64 elapsedMs);
+    void indexUpdated(int changedFiles, int removedFiles, qint64 elapsedMs);
+    void indexCleared();
+    // Ficheros que la construcción del índice descartó sin leerlos enteros
+    void filesSkipped(int files, qint64 bytesSaved);
+
+private:
+    struct UpdatePlan {
+        QStringList read;
+        QStringList removed;
+    };
+
+    struct UpdateResult {
+        std::shared_ptr<const DeepSeekSearchIndex> index;
+        int changedFiles = 0;
+        int removedFiles = 0;
+    };
+
+    void startBuild(const QStringList &paths);
+    void scheduleUpdate();
+    void startUpdate();
+    void onUpdatePlanned(const UpdatePlan &plan);
+    void onIngestionFinished();
+    void finishWork();
+
+    static UpdatePlan planUpdate(const std::shared_ptr<const DeepSeekSearchIndex> &index,
+                                 QStringList projectFiles, const QStringList &changedFiles);
+
+    DeepSeekFileIngestor *m_ingestor;
+    std::shared_ptr<DeepSeekProjectSnapshot::Builder> m_builder;
+    std::shared_ptr<const DeepSeekSearchIndex> m_index;
+    quint64 m_generation = 0;
+    QElapsedTimer m_timer;
+    DeepSeekFileIngestor::Stats m_ingestionStats;
+
+    // Cambios acumulados para la siguiente actualización
+    QTimer m_updateTimer;
+    QElapsedTimer m_firstPendingChange;
+    QSet<QString> m_changedFiles;
+    QStringList m_projectFiles;
+    bool m_syncPending = false;
+    // Una construcción o actualización en curso; lo que llegue mientras
+    // tanto espera a la siguiente
+    bool m_busy = false;
+    bool m_updating = false;
+    UpdatePlan m_updatePlan;
+
+    // Último miembro: se destruye primero y espera a la actualización en curso
+    QThreadPool m_pool;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
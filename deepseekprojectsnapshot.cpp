@@ -0,0 +1,147 @@
+#include "deepseekprojectsnapshot.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+void DeepSeekProjectSnapshot::Builder::reserve(qsizetype files, qsizetype bytes)
+{
+    m_snapshot->m_arena.reserve(bytes);
+    m_snapshot->m_entries.reserve(files);
+    m_snapshot->m_pathSegments.reserve(files * 4);
+}
+
+quint32 DeepSeekProjectSnapshot::Builder::intern(QStringView segment)
+{
+    // Por hash y comparando con el texto ya guardado: buscar no reserva memoria
+    DeepSeekProjectSnapshot &snapshot = *m_snapshot;
+    const size_t hash = qHash(segment);
+    const auto [first, last] = std::as_const(m_segmentIds).equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (snapshot.segment(it.value()) == segment)
+            return it.value();
+    }
+
+    const quint32 id = quint32(snapshot.m_segments.size());
+    snapshot.m_segments.append({quint32(snapshot.m_segmentText.size()), quint32(segment.size())});
+    snapshot.m_segmentText += segment;
+    m_segmentIds.insert(hash, id);
+    return id;
+}
+
+void DeepSeekProjectSnapshot::Builder::addFile(QStringView path, QByteArrayView content,
+                                                qint64 mtimeMs)
+{
+    DeepSeekProjectSnapshot &snapshot = *m_snapshot;
+
+    Entry entry;
+    entry.contentOffset = snapshot.m_arena.size();
+    entry.mtimeMs = mtimeMs;
+    entry.contentSize = quint32(content.size());
+    entry.pathOffset = quint32(snapshot.m_pathSegments.size());
+    for (QStringView segment : path.tokenize(u'/'))
+        snapshot.m_pathSegments.append(intern(segment));
+    entry.pathLength = quint32(snapshot.m_pathSegments.size()) - entry.pathOffset;
+
+    snapshot.m_arena.append(content.data(), content.size());
+    snapshot.m_entries.append(entry);
+}
+
+DeepSeekProjectSnapshot::Pointer DeepSeekProjectSnapshot::Builder::build()
+{
+    std::unique_ptr<DeepSeekProjectSnapshot> snapshot
+        = std::exchange(m_snapshot, std::unique_ptr<DeepSeekProjectSnapshot>(new DeepSeekProjectSnapshot));
+    m_segmentIds.clear();
+
+    // Los ficheros suelen llegar ya en orden; solo se ordena si hace falta
+    const auto less = [&snapshot](const Entry &a, const Entry &b) {
+        return snapshot->compareEntries(a, b) < 0;
+    };
+    if (!std::is_sorted(snapshot->m_entries.cbegin(), snapshot->m_entries.cend(), less))
+        std::stable_sort(snapshot->m_entries.begin(), snapshot->m_entries.end(), less);
+
+    // squeeze() copia el arena entero: solo compensa si sobra bastante
+    if (snapshot->m_arena.capacity() - snapshot->m_arena.size() > snapshot->m_arena.size() / 8)
+        snapshot->m_arena.squeeze();
+    snapshot->m_segmentText.squeeze();
+    snapshot->m_segments.squeeze();
+    snapshot->m_pathSegments.squeeze();
+    snapshot->m_entries.squeeze();
+
+    return Pointer(snapshot.release());
+}
+
+QStringView DeepSeekProjectSnapshot::segment(quint32 id) const
+{
+    const Segment &segment = m_segments.at(id);
+    return QStringView(m_segmentText).sliced(segment.offset, segment.length);
+}
+
+int DeepSeekProjectSnapshot::compareEntries(const Entry &a, const Entry &b) const
+{
+    const quint32 length = qMin(a.pathLength, b.pathLength);
+    for (quint32 i = 0; i < length; ++i) {
+        const quint32 left = m_pathSegments.at(a.pathOffset + i);
+        const quint32 right = m_pathSegments.at(b.pathOffset + i);
+        if (left == right)
+            continue;
+        if (const int order = segment(left).compare(segment(right)))
+            return order;
+    }
+    return int(a.pathLength) - int(b.pathLength);
+}
+
+QString DeepSeekProjectSnapshot::path(int file) const
+{
+    const Entry &entry = m_entries.at(file);
+    QString result;
+    for (quint32 i = 0; i < entry.pathLength; ++i) {
+        if (i > 0)
+            result += u'/';
+        result += segment(m_pathSegments.at(entry.pathOffset + i));
+    }
+    return result;
+}
+
+QByteArrayView DeepSeekProjectSnapshot::content(int file) const
+{
+    const Entry &entry = m_entries.at(file);
+    return QByteArrayView(m_arena.constData() + entry.contentOffset, entry.contentSize);
+}
+
+int DeepSeekProjectSnapshot::indexOf(QStringView path) const
+{
+    QList<QStringView> segments;
+    for (QStringView segment : path.tokenize(u'/'))
+        segments.append(segment);
+
+    // Mismo orden que compareEntries(), pero contra los segmentos de path
+    const auto compare = [this, &segments](const Entry &entry) {
+        const qsizetype length = qMin<qsizetype>(entry.pathLength, segments.size());
+        for (qsizetype i = 0; i < length; ++i) {
+            if (const int order = segment(m_pathSegments.at(entry.pathOffset + i)).compare(segments.at(i)))
+                return order;
+        }
+        return int(qsizetype(entry.pathLength) - segments.size());
+    };
+
+    const auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), 0,
+                                     [&compare](const Entry &entry, int) { return compare(entry) < 0; });
+    if (it == m_entries.cend() || compare(*it) != 0)
+        return -1;
+    return int(it - m_entries.cbegin());
+}
+
+qsizetype DeepSeekProjectSnapshot::memoryUsage() const
+{
+    return m_arena.capacity()
+           + m_segmentText.capacity() * qsizetype(sizeof(QChar))
+           + m_segments.capacity() * qsizetype(sizeof(Segment))
+           + m_pathSegments.capacity() * qsizetype(sizeof(quint32))
+           + m_entries.capacity() * qsizetype(sizeof(Entry));
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
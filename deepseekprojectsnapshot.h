@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <memory>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Contenido de un proyecto en memoria, de solo lectura.
+//
+// Todos los ficheros van seguidos en un único arena de UTF-8. Las rutas se
+// guardan como secuencias de segmentos internados ("home", "src",
+// "main.cpp"), así que un directorio compartido por miles de ficheros se
+// guarda una vez. El índice es una lista plana, ordenada por ruta, de
+// vistas (desplazamiento, tamaño) al arena: no hay un nodo ni una cadena
+// por fichero. Se construye con Builder y se comparte entre hilos como
+// std::shared_ptr<const DeepSeekProjectSnapshot>; nada cambia después.
+class DeepSeekProjectSnapshot
+{
+public:
+    using Pointer = std::shared_ptr<const DeepSeekProjectSnapshot>;
+
+    class Builder
+    {
+    public:
+        void reserve(qsizetype files, qsizetype bytes);
+        void addFile(QStringView path, QByteArrayView content, qint64 mtimeMs = 0);
+
+        int fileCount() const { return int(m_snapshot->m_entries.size()); }
+        qsizetype bytes() const { return m_snapshot->m_arena.size(); }
+
+        // Deja el Builder vacío
+        Pointer build();
+
+    private:
+        quint32 intern(QStringView segment);
+
+        std::unique_ptr<DeepSeekProjectSnapshot> m_snapshot{new DeepSeekProjectSnapshot};
+        QMultiHash<size_t, quint32> m_segmentIds;   // hash del segmento -> id
+    };
+
+    int fileCount() const { return int(m_entries.size()); }
+    QString path(int file) const;
+    QByteArrayView content(int file) const;
+    qint64 mtimeMs(int file) const { return m_entries.at(file).mtimeMs; }
+    // -1 si el fichero no está
+    int indexOf(QStringView path) const;
+
+    qsizetype totalBytes() const { return m_arena.size(); }
+    // Memoria ocupada por las estructuras (sin contar el propio objeto)
+    qsizetype memoryUsage() const;
+
+private:
+    DeepSeekProjectSnapshot() = default;
+
+    struct Segment {
+        quint32 offset;     // en m_segmentText
+        quint32 length;
+    };
+
+    struct Entry {
+        qsizetype contentOffset = 0;
+        qint64 mtimeMs = 0;         // para saber si el fichero cambió en disco
+        quint32 contentSize = 0;
+        quint32 pathOffset = 0;     // primer segmento en m_pathSegments
+        quint32 pathLength = 0;     // nº de segmentos
+    };
+
+    QStringView segment(quint32 id) const;
+    int compareEntries(const Entry &a, const Entry &b) const;
+
+    QByteArray m_arena;
+    QString m_segmentText;
+    QList<Segment> m_segments;
+    QList<quint32> m_pathSegments;
+    QList<Entry> m_entries;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,304 @@
+#include "deepseekrequest.h"
+
+#include <QNetworkAccessManager>
+#include <QDateTime>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+DeepSeekRequest::DeepSeekRequest(quint64 id, const QString &mode, QObject *parent)
+    : QObject(parent),
+      m_id(id),
+      m_mode(mode)
+{
+    m_timeoutTimer.setSingleShot(true);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &DeepSeekRequest::onTimeout);
+}
+
+DeepSeekRequest::~DeepSeekRequest()
+{
+    if (m_reply) {
+        disconnect(m_reply, nullptr, this, nullptr);
+        m_reply->abort();
+        m_reply->deleteLater();
+    }
+}
+
+void DeepSeekRequest::setNetworkRequest(const QNetworkRequest &request, const QByteArray &payload,
+                                        bool streaming)
+{
+    m_request = request;
+    m_payload = payload;
+    m_streaming = streaming;
+}
+
+QString DeepSeekRequest::endpoint() const
+{
+    const QUrl url = m_request.url();
+    return url.host() + url.path();
+}
+
+void DeepSeekRequest::start(QNetworkAccessManager *manager)
+{
+    if (m_state != Pending)
+        return;
+
+    m_state = Running;
+    ++m_attempt;
+    m_timedOut = false;
+    m_streamParser.reset();
+    // La latencia total incluye los reintentos
+    if (!m_timer.isValid())
+        m_timer.start();
+    m_attemptTimer.start();
+    m_newConnection = false;
+    m_connectionSetupMs = -1;
+    m_reply = manager->post(m_request, m_payload);
+
+    // Sin socketStartedConnecting la petición viajó por una conexión ya abierta
+    connect(m_reply, &QNetworkReply::socketStartedConnecting, this, [this]() {
+        m_newConnection = true;
+    });
+    connect(m_reply, &QNetworkReply::requestSent, this, [this]() {
+        if (m_connectionSetupMs < 0)
+            m_connectionSetupMs = m_newConnection ? m_attemptTimer.elapsed() : 0;
+    });
+
+    if (m_streaming)
+        connect(m_reply, &QNetworkReply::readyRead, this, &DeepSeekRequest::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &DeepSeekRequest::onReplyFinished);
+
+    m_timeoutTimer.start(m_timeoutMs);
+    emit started();
+}
+
+void DeepSeekRequest::startFromCache(const QString &content)
+{
+    if (m_state != Pending)
+        return;
+
+    m_state = Running;
+    m_fromCache = true;
+    m_timer.start();
+    emit started();
+
+    // Se completa en la siguiente vuelta del bucle para que quien creó el
+    // handle pueda conectarse a sus señales antes
+    QTimer::singleShot(0, this, [this, content]() {
+        if (!isActive())
+            return;
+        m_content = content;
+        m_firstTokenMs = m_timer.elapsed();
+        finish(Finished);
+    });
+}
+
+void DeepSeekRequest::cancel()
+{
+    if (!isActive())
+        return;
+
+    m_networkError = QNetworkReply::OperationCanceledError;
+    m_errorString = tr("Request cancelled");
+    if (m_reply) {
+        disconnect(m_reply, nullptr, this, nullptr);
+        m_reply->abort();
+    }
+    finish(Cancelled);
+}
+
+void DeepSeekRequest::onReadyRead()
+{
+    // Los errores HTTP llegan como JSON normal, se tratan al terminar
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400)
+        return;
+
+    // En streaming el límite es de inactividad: cada fragmento lo reinicia
+    m_timeoutTimer.start(m_timeoutMs);
+    handleStreamEvents(m_streamParser.feed(m_reply->readAll()));
+}
+
+void DeepSeekRequest::onReplyFinished()
+{
+    if (!isActive())
+        return;
+
+    m_totalMs = m_timer.elapsed();
+    m_httpStatus = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    m_usedHttp2 = m_reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+
+    if (m_reply->error() != QNetworkReply::NoError) {
+        if (isRetryable()) {
+            const int delay = retryAfterMs();
+            disconnect(m_reply, nullptr, this, nullptr);
+            m_reply->deleteLater();
+            m_reply = nullptr;
+            m_timeoutTimer.stop();
+            m_totalMs = -1;
+            m_state = Pending;
+            emit retryRequested(delay);
+            return;
+        }
+
+        m_networkError = m_timedOut ? QNetworkReply::TimeoutError : m_reply->error();
+        m_errorString = m_reply->errorString();
+
+        // La API describe el problema en {"error": {"message": ...}}
+        ChatCompletionResult result;
+        DeepSeekResponseParser::parseWithFallback(m_reply->readAll(), &result);
+        if (!result.errorMessage.isEmpty())
+            m_errorString = result.errorMessage;
+
+        finish(Failed);
+        return;
+    }
+
+    if (m_streaming) {
+        // Quien recibe partialContent puede cancelar la petición desde él
+        handleStreamEvents(m_streamParser.feed(m_reply->readAll()));
+        if (!isActive())
+            return;
+        handleStreamEvents(m_streamParser.flush());
+        if (!isActive())
+            return;
+        if (m_content.isEmpty()) {
+            m_errorString = tr("Empty content in API response");
+            finish(Failed);
+            return;
+        }
+        finish(Finished);
+        return;
+    }
+
+    finish(parseResponseBody(m_reply->readAll()) ? Finished : Failed);
+}
+
+void DeepSeekRequest::onTimeout()
+{
+    if (!m_reply)
+        return;
+
+    m_timedOut = true;
+    m_reply->abort();
+}
+
+void DeepSeekRequest::handleStreamEvents(const QList<QByteArray> &events)
+{
+    QString delta;
+    for (const QByteArray &event : events) {
+        ChatCompletionResult chunk;
+        if (!DeepSeekResponseParser::parseWithFallback(event, &chunk))
+            continue;
+        delta += chunk.content;
+        // finish_reason y usage solo llegan en el último fragmento
+        if (!chunk.finishReason.isEmpty())
+            m_finishReason = chunk.finishReason;
+        if (chunk.usage.isValid())
+            m_usage = chunk.usage;
+    }
+
+    if (delta.isEmpty())
+        return;
+
+    if (m_firstTokenMs < 0)
+        m_firstTokenMs = m_timer.elapsed();
+
+    m_content += delta;
+    emit partialContent(delta);
+}
+
+bool DeepSeekRequest::isRetryable() const
+{
+    if (m_attempt >= m_maxAttempts || m_timedOut || !m_content.isEmpty())
+        return false;
+
+    switch (m_httpStatus) {
+    case 429: // Too Many Requests
+    case 500:
+    case 502:
+    case 503: // Servidor saturado
+    case 504:
+        return true;
+    default:
+        break;
+    }
+
+    return m_reply->error() == QNetworkReply::TemporaryNetworkFailureError
+           || m_reply->error() == QNetworkReply::RemoteHostClosedError;
+}
+
+int DeepSeekRequest::retryAfterMs() const
+{
+    // Retry-After puede ser un número de segundos o una fecha HTTP
+    const QByteArray header = m_reply->rawHeader("Retry-After").trimmed();
+    if (header.isEmpty())
+        return -1;
+
+    bool ok = false;
+    const int seconds = header.toInt(&ok);
+    if (ok)
+        return qMax(0, seconds) * 1000;
+
+    const QDateTime when = QDateTime::fromString(QString::fromLatin1(header), Qt::RFC2822Date);
+    if (!when.isValid())
+        return -1;
+    return int(qBound<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(when), 3600 * 1000));
+}
+
+bool DeepSeekRequest::parseResponseBody(const QByteArray &body)
+{
+    ChatCompletionResult result;
+    if (!DeepSeekResponseParser::parseWithFallback(body, &result)) {
+        m_errorString = tr("Invalid JSON response format");
+        return false;
+    }
+
+    if (!result.hasChoices) {
+        m_errorString = tr("API response missing 'choices' array");
+        return false;
+    }
+
+    m_content = result.content;
+    m_finishReason = result.finishReason;
+    m_usage = result.usage;
+    if (m_content.isEmpty()) {
+        m_errorString = tr("Empty content in API response");
+        return false;
+    }
+
+    return true;
+}
+
+void DeepSeekRequest::finish(State state)
+{
+    m_state = state;
+    m_timeoutTimer.stop();
+    if (m_totalMs < 0)
+        m_totalMs = m_timer.isValid() ? m_timer.elapsed() : 0;
+
+    if (m_reply) {
+        disconnect(m_reply, nullptr, this, nullptr);
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+
+    switch (state) {
+    case Finished:
+        emit finished(m_content);
+        break;
+    case Failed:
+        emit failed(m_errorString);
+        break;
+    case Cancelled:
+        emit cancelled();
+        break;
+    default:
+        break;
+    }
+
+    emit completed();
+    deleteLater();
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
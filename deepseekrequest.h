@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QObject>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "deepseekresponseparser.h"
+#include "deepseekstreamparser.h"
+
+class QNetworkAccessManager;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Handle de una petición a la API. Cada petición tiene su propio id, se
+// puede cancelar y termina por un único camino: finished(), failed() o
+// cancelled(), seguido siempre de completed(). El handle se autodestruye
+// (deleteLater) después de completed().
+//
+// Si la API responde 429/5xx antes de enviar contenido y quedan intentos,
+// la petición vuelve a Pending y emite retryRequested() en lugar de fallar;
+// quien la planifica decide cuándo volver a llamar a start().
+class DeepSeekRequest : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Pending,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+    Q_ENUM(State)
+
+    DeepSeekRequest(quint64 id, const QString &mode, QObject *parent = nullptr);
+    ~DeepSeekRequest() override;
+
+    quint64 id() const { return m_id; }
+    QString mode() const { return m_mode; }
+    State state() const { return m_state; }
+    bool isActive() const { return m_state == Pending || m_state == Running; }
+    bool isStreaming() const { return m_streaming; }
+
+    void setNetworkRequest(const QNetworkRequest &request, const QByteArray &payload,
+                           bool streaming);
+    void setTimeout(int msecs) { m_timeoutMs = msecs; }
+    void setMaxAttempts(int attempts) { m_maxAttempts = qMax(1, attempts); }
+
+    QString endpoint() const;
+    int attempt() const { return m_attempt; }
+
+    void start(QNetworkAccessManager *manager);
+    // Completa la petición sin red con una respuesta ya conocida
+    void startFromCache(const QString &content);
+    bool isFromCache() const { return m_fromCache; }
+
+    QString content() const { return m_content; }
+    // "stop", "length"...; vacío si la API no lo indicó
+    QString finishReason() const { return m_finishReason; }
+    // Consumo de tokens; en streaming solo si la API lo incluye en el último evento
+    ChatCompletionUsage usage() const { return m_usage; }
+    QNetworkReply::NetworkError networkError() const { return m_networkError; }
+    int httpStatus() const { return m_httpStatus; }
+    QString errorString() const { return m_errorString; }
+
+    qint64 firstTokenMs() const { return m_firstTokenMs; }
+    qint64 totalMs() const { return m_totalMs; }
+    // Tiempo de DNS + TCP + TLS del último intento; 0 si se reutilizó una
+    // conexión abierta, -1 si no se llegó a enviar
+    qint64 connectionSetupMs() const { return m_connectionSetupMs; }
+    bool usedHttp2() const { return m_usedHttp2; }
+
+public slots:
+    void cancel();
+
+signals:
+    void started();
+    void retryRequested(int retryAfterMs);
+    void partialContent(const QString &chunk);
+    void finished(const QString &content);
+    void failed(const QString &errorString);
+    void cancelled();
+    void completed();
+
+private:
+    void onReadyRead();
+    void onReplyFinished();
+    void onTimeout();
+    void handleStreamEvents(const QList<QByteArray> &events);
+    bool parseResponseBody(const QByteArray &body);
+    bool isRetryable() const;
+    int retryAfterMs() const;
+    void finish(State state);
+
+    const quint64 m_id;
+    const QString m_mode;
+    State m_state = Pending;
+
+    QNetworkRequest m_request;
+    QByteArray m_payload;
+    bool m_streaming = false;
+    int m_timeoutMs = 30000;
+    bool m_timedOut = false;
+    int m_maxAttempts = 1;
+    int m_attempt = 0;
+    bool m_fromCache = false;
+
+    QNetworkReply *m_reply = nullptr;
+    QTimer m_timeoutTimer;
+    QElapsedTimer m_timer;
+    QElapsedTimer m_attemptTimer;
+    bool m_newConnection = false;
+    DeepSeekStreamParser m_streamParser;
+
+    QString m_content;
+    QString m_finishReason;
+    ChatCompletionUsage m_usage;
+    QNetworkReply::NetworkError m_networkError = QNetworkReply::NoError;
+    int m_httpStatus = 0;
+    QString m_errorString;
+    qint64 m_firstTokenMs = -1;
+    qint64 m_totalMs = -1;
+    qint64 m_connectionSetupMs = -1;
+    bool m_usedHttp2 = false;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
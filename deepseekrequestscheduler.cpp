@@ -0,0 +1,217 @@
+#include "deepseekrequestscheduler.h"
+#include "deepseekrequest.h"
+
+#include <QRandomGenerator>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+DeepSeekRequestScheduler::DeepSeekRequestScheduler(QNetworkAccessManager *manager, QObject *parent)
+    : QObject(parent),
+      m_manager(manager)
+{
+    m_clock.start();
+    m_dispatchTimer.setSingleShot(true);
+    connect(&m_dispatchTimer, &QTimer::timeout, this, &DeepSeekRequestScheduler::dispatch);
+}
+
+void DeepSeekRequestScheduler::enqueue(DeepSeekRequest *request, Priority priority)
+{
+    if (!request || !request->isActive())
+        return;
+
+    request->setMaxAttempts(m_maxAttempts);
+
+    connect(request, &DeepSeekRequest::retryRequested, this,
+            [this, request, priority](int retryAfterMs) {
+        onRetryRequested(request, priority, retryAfterMs);
+    });
+
+    const quint64 id = request->id();
+    connect(request, &DeepSeekRequest::completed, this, [this, id]() {
+        if (m_inFlight.contains(id)) {
+            const QString endpoint = m_inFlight.take(id);
+            --m_running[endpoint];
+        } else {
+            // Cancelada mientras esperaba en la cola
+            for (QQueue<Entry> &queue : m_queues) {
+                queue.removeIf([id](const Entry &entry) { return entry.id == id; });
+            }
+        }
+        updateStats();
+        dispatch();
+    });
+
+    Entry entry;
+    entry.id = id;
+    entry.request = request;
+    entry.endpoint = request->endpoint();
+    entry.queuedTimer.start();
+    m_queues[priority].enqueue(entry);
+
+    updateStats();
+    dispatch();
+}
+
+void DeepSeekRequestScheduler::setMaxConcurrentPerEndpoint(int max)
+{
+    m_maxConcurrentPerEndpoint = qMax(1, max);
+    dispatch();
+}
+
+void DeepSeekRequestScheduler::setRateLimit(double requestsPerSecond, int burst)
+{
+    // requestsPerSecond <= 0 desactiva el token bucket
+    m_tokensPerMs = requestsPerSecond > 0 ? requestsPerSecond / 1000.0 : -1.0;
+    m_bucketSize = qMax(1, burst);
+    m_tokens = qMin(m_tokens, m_bucketSize);
+    dispatch();
+}
+
+int DeepSeekRequestScheduler::queuedCount() const
+{
+    int count = 0;
+    for (const QQueue<Entry> &queue : m_queues)
+        count += queue.size();
+    return count;
+}
+
+void DeepSeekRequestScheduler::dispatch()
+{
+    refillTokens();
+
+    const qint64 now = m_clock.elapsed();
+    qint64 nextWakeMs = -1;
+    auto wakeIn = [&nextWakeMs](qint64 ms) {
+        if (nextWakeMs < 0 || ms < nextWakeMs)
+            nextWakeMs = ms;
+    };
+
+    for (QQueue<Entry> &queue : m_queues) {
+        for (qsizetype i = 0; i < queue.size();) {
+            const Entry &entry = queue.at(i);
+            if (!entry.request || !entry.request->isActive()) {
+                queue.removeAt(i);
+                continue;
+            }
+
+            const qint64 blockedUntil = m_blockedUntil.value(entry.endpoint, 0);
+            if (blockedUntil > now) {
+                wakeIn(blockedUntil - now);
+                ++i;
+                continue;
+            }
+
+            if (m_running.value(entry.endpoint) >= m_maxConcurrentPerEndpoint) {
+                // Se vuelve a intentar cuando termine alguna petición
+                ++i;
+                continue;
+            }
+
+            if (m_tokensPerMs > 0 && m_tokens < 1.0) {
+                wakeIn(qint64((1.0 - m_tokens) / m_tokensPerMs) + 1);
+                scheduleDispatch(int(nextWakeMs));
+                updateStats();
+                return;
+            }
+
+            if (m_tokensPerMs > 0)
+                m_tokens -= 1.0;
+            startEntry(queue.takeAt(i));
+        }
+    }
+
+    if (nextWakeMs >= 0)
+        scheduleDispatch(int(nextWakeMs));
+    updateStats();
+}
+
+void DeepSeekRequestScheduler::scheduleDispatch(int delayMs)
+{
+    if (m_dispatchTimer.isActive() && m_dispatchTimer.remainingTime() <= delayMs)
+        return;
+    m_dispatchTimer.start(delayMs);
+}
+
+void DeepSeekRequestScheduler::startEntry(Entry entry)
+{
+    const qint64 waitMs = entry.queuedTimer.elapsed();
+    ++m_stats.dispatched;
+    m_stats.lastWaitMs = waitMs;
+    m_stats.totalWaitMs += waitMs;
+    m_stats.maxWaitMs = qMax(m_stats.maxWaitMs, waitMs);
+    m_statsDirty = true;
+
+    m_inFlight.insert(entry.id, entry.endpoint);
+    ++m_running[entry.endpoint];
+    entry.request->start(m_manager);
+}
+
+void DeepSeekRequestScheduler::onRetryRequested(DeepSeekRequest *request, Priority priority,
+                                                int retryAfterMs)
+{
+    const QString endpoint = m_inFlight.take(request->id());
+    if (!endpoint.isEmpty())
+        --m_running[endpoint];
+
+    int delayMs = backoffDelayMs(request->attempt());
+    if (retryAfterMs >= 0) {
+        // El servidor manda: se pausa todo el endpoint, no solo esta petición
+        delayMs = retryAfterMs + int(QRandomGenerator::global()->bounded(250));
+        m_blockedUntil[request->endpoint()] = m_clock.elapsed() + retryAfterMs;
+    }
+
+    ++m_stats.retries;
+    m_statsDirty = true;
+    emit retryScheduled(request->id(), request->attempt(), delayMs);
+
+    QTimer::singleShot(delayMs, request, [this, request, priority]() {
+        if (!request->isActive())
+            return;
+        Entry entry;
+        entry.id = request->id();
+        entry.request = request;
+        entry.endpoint = request->endpoint();
+        entry.queuedTimer.start();
+        // Los reintentos no vuelven al final de la cola
+        m_queues[priority].prepend(entry);
+        dispatch();
+    });
+
+    updateStats();
+    dispatch();
+}
+
+void DeepSeekRequestScheduler::refillTokens()
+{
+    const qint64 now = m_clock.elapsed();
+    if (m_tokensPerMs > 0)
+        m_tokens = qMin(m_bucketSize, m_tokens + (now - m_lastRefillMs) * m_tokensPerMs);
+    m_lastRefillMs = now;
+}
+
+int DeepSeekRequestScheduler::backoffDelayMs(int attempt) const
+{
+    // 1 s, 2 s, 4 s... hasta 30 s, con jitter en la mitad superior del intervalo
+    const int base = qMin(30000, 1000 << qBound(0, attempt - 1, 5));
+    return base / 2 + int(QRandomGenerator::global()->bounded(base / 2 + 1));
+}
+
+void DeepSeekRequestScheduler::updateStats()
+{
+    int running = 0;
+    for (int count : std::as_const(m_running))
+        running += count;
+
+    const int queued = queuedCount();
+    if (queued == m_stats.queued && running == m_stats.running && !m_statsDirty)
+        return;
+
+    m_stats.queued = queued;
+    m_stats.running = running;
+    m_statsDirty = false;
+    emit statsChanged(m_stats);
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QNetworkAccessManager;
+
+namespace DeepSeekAI {
+namespace Internal {
+
+class DeepSeekRequest;
+
+// Planificador delante de DeepSeekTool. Mantiene una cola por prioridad,
+// limita las peticiones simultáneas por endpoint, reparte los envíos con un
+// token bucket y reintenta los 429/5xx con backoff exponencial + jitter
+// (o con el tiempo indicado en Retry-After).
+class DeepSeekRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Interactive = 0,   // fix / generación de código
+        Normal,
+        Background         // análisis de proyecto
+    };
+    Q_ENUM(Priority)
+
+    struct Stats {
+        int queued = 0;
+        int running = 0;
+        int retries = 0;
+        quint64 dispatched = 0;
+        qint64 lastWaitMs = 0;
+        qint64 maxWaitMs = 0;
+        qint64 totalWaitMs = 0;
+
+        qint64 averageWaitMs() const { return dispatched ? totalWaitMs / qint64(dispatched) : 0; }
+    };
+
+    explicit DeepSeekRequestScheduler(QNetworkAccessManager *manager, QObject *parent = nullptr);
+
+    void enqueue(DeepSeekRequest *request, Priority priority);
+
+    void setMaxConcurrentPerEndpoint(int max);
+    void setRateLimit(double requestsPerSecond, int burst);
+    void setMaxAttempts(int attempts) { m_maxAttempts = qMax(1, attempts); }
+
+    Stats stats() const { return m_stats; }
+    int queuedCount() const;
+
+signals:
+    void statsChanged(const DeepSeekAI::Internal::DeepSeekRequestScheduler::Stats &stats);
+    void retryScheduled(quint64 requestId, int attempt, int delayMs);
+
+private:
+    struct Entry {
+        quint64 id = 0;
+        QPointer<DeepSeekRequest> request;
+        QString endpoint;
+        QElapsedTimer queuedTimer;
+    };
+
+    void dispatch();
+    void scheduleDispatch(int delayMs);
+    void startEntry(Entry entry);
+    void onRetryRequested(DeepSeekRequest *request, Priority priority, int retryAfterMs);
+    void refillTokens();
+    int backoffDelayMs(int attempt) const;
+    void updateStats();
+
+    QNetworkAccessManager *m_manager;
+    QQueue<Entry> m_queues[Background + 1];
+    QHash<QString, int> m_running;
+    QHash<quint64, QString> m_inFlight;      // id -> endpoint
+    QHash<QString, qint64> m_blockedUntil;   // pausas por Retry-After, en ms de m_clock
+
+    int m_maxConcurrentPerEndpoint = 4;
+    int m_maxAttempts = 4;
+
+    // Token bucket
+    double m_tokensPerMs = 0.002;
+    double m_bucketSize = 4;
+    double m_tokens = 4;
+    qint64 m_lastRefillMs = 0;
+
+    QElapsedTimer m_clock;
+    QTimer m_dispatchTimer;
+    Stats m_stats;
+    bool m_statsDirty = false;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
+
+Q_DECLARE_METATYPE(DeepSeekAI::Internal::DeepSeekRequestScheduler::Stats)
@@ -0,0 +1,352 @@
+#include "deepseekresponsecache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// responses.dat: registros [magic][clave 32][longitud 4][valor]
+const char kRecordMagic[4] = {'D', 'S', 'R', '1'};
+const int kKeySize = 32;
+const int kRecordHeaderSize = 4 + kKeySize + 4;
+
+// responses.idx: cabecera + entradas de tamaño fijo
+const char kIndexMagic[4] = {'D', 'S', 'I', '1'};
+const int kIndexHeaderSize = 24;   // magic, versión, nº entradas, reservado, tamaño de datos
+const int kIndexEntrySize = 56;    // clave, offset, longitud, reservado, lastUsed
+const quint32 kIndexVersion = 1;
+
+// Con menos basura que esto no merece la pena reescribir el fichero
+const qint64 kMinCompactBytes = 1024 * 1024;
+
+} // namespace
+
+DeepSeekResponseCache::DeepSeekResponseCache() = default;
+
+DeepSeekResponseCache::~DeepSeekResponseCache()
+{
+    close();
+}
+
+bool DeepSeekResponseCache::open(const QString &directory)
+{
+    close();
+
+    if (!QDir().mkpath(directory))
+        return false;
+
+    m_directory = directory;
+    m_data.setFileName(directory + "/responses.dat");
+    if (!m_data.open(QIODevice::ReadWrite))
+        return false;
+
+    qint64 indexedDataSize = 0;
+    if (!loadIndex(&indexedDataSize) || indexedDataSize > m_data.size()) {
+        // Índice ausente o incoherente: se reconstruye desde los datos
+        m_entries.clear();
+        m_liveBytes = 0;
+        m_deadBytes = 0;
+        indexedDataSize = 0;
+    }
+
+    recoverTail(indexedDataSize);
+    return true;
+}
+
+void DeepSeekResponseCache::close()
+{
+    if (!m_data.isOpen())
+        return;
+
+    flush();
+    m_data.close();
+    m_entries.clear();
+    m_liveBytes = 0;
+    m_deadBytes = 0;
+}
+
+void DeepSeekResponseCache::setMaxSize(qint64 bytes)
+{
+    m_maxBytes = qMax<qint64>(0, bytes);
+    evictToFit();
+}
+
+QByteArray DeepSeekResponseCache::keyFor(const QByteArray &canonicalRequest)
+{
+    return QCryptographicHash::hash(canonicalRequest, QCryptographicHash::Sha256);
+}
+
+bool DeepSeekResponseCache::lookup(const QByteArray &key, QString *content)
+{
+    auto it = m_entries.find(key);
+    if (!isOpen() || it == m_entries.end()) {
+        ++m_stats.misses;
+        return false;
+    }
+
+    if (!m_data.seek(qint64(it->offset) + kRecordHeaderSize)) {
+        ++m_stats.misses;
+        return false;
+    }
+
+    const QByteArray value = m_data.read(it->length);
+    if (value.size() != qsizetype(it->length)) {
+        // Registro truncado: se descarta la entrada
+        m_deadBytes += recordSize(*it);
+        m_liveBytes -= recordSize(*it);
+        m_entries.erase(it);
+        ++m_unsavedChanges;
+        ++m_stats.misses;
+        return false;
+    }
+
+    it->lastUsed = ++m_clock;
+    ++m_unsavedChanges;
+    ++m_stats.hits;
+    *content = QString::fromUtf8(value);
+    return true;
+}
+
+void DeepSeekResponseCache::insert(const QByteArray &key, const QString &content)
+{
+    if (!isOpen() || key.size() != kKeySize)
+        return;
+
+    const QByteArray value = content.toUtf8();
+    if (kRecordHeaderSize + value.size() > m_maxBytes)
+        return;
+
+    const qint64 offset = m_data.size();
+    if (!m_data.seek(offset))
+        return;
+
+    char header[kRecordHeaderSize];
+    std::memcpy(header, kRecordMagic, 4);
+    std::memcpy(header + 4, key.constData(), kKeySize);
+    qToLittleEndian<quint32>(quint32(value.size()), header + 4 + kKeySize);
+
+    if (m_data.write(header, kRecordHeaderSize) != kRecordHeaderSize
+        || m_data.write(value) != value.size()) {
+        m_data.resize(offset);
+        return;
+    }
+
+    auto existing = m_entries.constFind(key);
+    if (existing != m_entries.constEnd()) {
+        m_liveBytes -= recordSize(*existing);
+        m_deadBytes += recordSize(*existing);
+    }
+
+    Entry entry;
+    entry.offset = quint64(offset);
+    entry.length = quint32(value.size());
+    entry.lastUsed = ++m_clock;
+    m_entries.insert(key, entry);
+    m_liveBytes += recordSize(entry);
+
+    evictToFit();
+
+    if (m_deadBytes > kMinCompactBytes && m_deadBytes > m_liveBytes)
+        compact();
+    else if (++m_unsavedChanges >= 16)
+        writeIndex();
+}
+
+void DeepSeekResponseCache::flush()
+{
+    if (!isOpen())
+        return;
+
+    m_data.flush();
+    if (m_unsavedChanges > 0)
+        writeIndex();
+}
+
+DeepSeekResponseCache::Stats DeepSeekResponseCache::stats() const
+{
+    Stats stats = m_stats;
+    stats.entries = m_entries.size();
+    stats.liveBytes = m_liveBytes;
+    return stats;
+}
+
+bool DeepSeekResponseCache::loadIndex(qint64 *indexedDataSize)
+{
+    QFile index(m_directory + "/responses.idx");
+    if (!index.open(QIODevice::ReadOnly) || index.size() < kIndexHeaderSize)
+        return false;
+
+    const qint64 size = index.size();
+    const uchar *map = index.map(0, size);
+    if (!map)
+        return false;
+
+    const auto *bytes = reinterpret_cast<const char *>(map);
+    const quint32 count = qFromLittleEndian<quint32>(bytes + 8);
+    if (std::memcmp(bytes, kIndexMagic, 4) != 0
+        || qFromLittleEndian<quint32>(bytes + 4) != kIndexVersion
+        || size < kIndexHeaderSize + qint64(count) * kIndexEntrySize) {
+        index.unmap(const_cast<uchar *>(map));
+        return false;
+    }
+
+    *indexedDataSize = qFromLittleEndian<qint64>(bytes + 16);
+
+    m_entries.reserve(count);
+    const char *p = bytes + kIndexHeaderSize;
+    for (quint32 i = 0; i < count; ++i, p += kIndexEntrySize) {
+        Entry entry;
+        entry.offset = qFromLittleEndian<quint64>(p + 32);
+        entry.length = qFromLittleEndian<quint32>(p + 40);
+        entry.lastUsed = qFromLittleEndian<quint64>(p + 48);
+        if (qint64(entry.offset) + recordSize(entry) > *indexedDataSize)
+            continue;
+        m_entries.insert(QByteArray(p, kKeySize), entry);
+        m_liveBytes += recordSize(entry);
+        m_clock = qMax(m_clock, entry.lastUsed);
+    }
+
+    index.unmap(const_cast<uchar *>(map));
+    m_deadBytes = qMax<qint64>(0, *indexedDataSize - m_liveBytes);
+    return true;
+}
+
+void DeepSeekResponseCache::recoverTail(qint64 from)
+{
+    const qint64 dataSize = m_data.size();
+    qint64 offset = from;
+
+    while (offset + kRecordHeaderSize <= dataSize) {
+        if (!m_data.seek(offset))
+            break;
+
+        char header[kRecordHeaderSize];
+        if (m_data.read(header, kRecordHeaderSize) != kRecordHeaderSize
+            || std::memcmp(header, kRecordMagic, 4) != 0) {
+            break;
+        }
+
+        Entry entry;
+        entry.offset = quint64(offset);
+        entry.length = qFromLittleEndian<quint32>(header + 4 + kKeySize);
+        entry.lastUsed = ++m_clock;
+        if (offset + recordSize(entry) > dataSize)
+            break;
+
+        const QByteArray key(header + 4, kKeySize);
+        auto existing = m_entries.constFind(key);
+        if (existing != m_entries.constEnd()) {
+            m_liveBytes -= recordSize(*existing);
+            m_deadBytes += recordSize(*existing);
+        }
+        m_entries.insert(key, entry);
+        m_liveBytes += recordSize(entry);
+        offset += recordSize(entry);
+        ++m_unsavedChanges;
+    }
+
+    // Un registro a medio escribir se corta para no corromper los siguientes
+    if (offset < dataSize)
+        m_data.resize(offset);
+
+    evictToFit();
+}
+
+bool DeepSeekResponseCache::writeIndex()
+{
+    QSaveFile index(m_directory + "/responses.idx");
+    if (!index.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray buffer(kIndexHeaderSize + m_entries.size() * kIndexEntrySize, '\0');
+    char *p = buffer.data();
+    std::memcpy(p, kIndexMagic, 4);
+    qToLittleEndian<quint32>(kIndexVersion, p + 4);
+    qToLittleEndian<quint32>(quint32(m_entries.size()), p + 8);
+    qToLittleEndian<qint64>(m_data.size(), p + 16);
+
+    p += kIndexHeaderSize;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it, p += kIndexEntrySize) {
+        std::memcpy(p, it.key().constData(), kKeySize);
+        qToLittleEndian<quint64>(it->offset, p + 32);
+        qToLittleEndian<quint32>(it->length, p + 40);
+        qToLittleEndian<quint64>(it->lastUsed, p + 48);
+    }
+
+    index.write(buffer);
+    if (!index.commit())
+        return false;
+
+    m_unsavedChanges = 0;
+    return true;
+}
+
+void DeepSeekResponseCache::evictToFit()
+{
+    while (m_liveBytes > m_maxBytes && !m_entries.isEmpty()) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+
+        m_liveBytes -= recordSize(*oldest);
+        m_deadBytes += recordSize(*oldest);
+        m_entries.erase(oldest);
+        ++m_stats.evictions;
+        ++m_unsavedChanges;
+    }
+}
+
+void DeepSeekResponseCache::compact()
+{
+    QSaveFile compacted(m_data.fileName());
+    if (!compacted.open(QIODevice::WriteOnly))
+        return;
+
+    QHash<QByteArray, Entry> moved;
+    moved.reserve(m_entries.size());
+    qint64 offset = 0;
+
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        const qint64 size = recordSize(*it);
+        if (!m_data.seek(qint64(it->offset)))
+            continue;
+        const QByteArray record = m_data.read(size);
+        if (record.size() != size)
+            continue;
+
+        compacted.write(record);
+        Entry entry = *it;
+        entry.offset = quint64(offset);
+        moved.insert(it.key(), entry);
+        offset += size;
+    }
+
+    m_data.close();
+    if (!compacted.commit()) {
+        m_data.open(QIODevice::ReadWrite);
+        return;
+    }
+
+    m_data.open(QIODevice::ReadWrite);
+    m_entries = moved;
+    m_liveBytes = offset;
+    m_deadBytes = 0;
+    writeIndex();
+}
+
+qint64 DeepSeekResponseCache::recordSize(const Entry &entry) const
+{
+    return kRecordHeaderSize + qint64(entry.length);
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
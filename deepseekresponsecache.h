@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Caché persistente de respuestas, direccionada por contenido.
+//
+// La clave es el SHA-256 del cuerpo canónico de la petición (modelo,
+// mensajes, temperature y max_tokens). Las respuestas se añaden al final de
+// responses.dat y nunca se reescriben en su sitio; responses.idx guarda una
+// tabla de entradas de tamaño fijo que se mapea en memoria al arrancar. Si el
+// índice quedó atrasado (cierre abrupto), los registros que faltan se
+// recuperan recorriendo la cola del fichero de datos.
+//
+// El tamaño total se limita expulsando las entradas usadas hace más tiempo
+// (LRU); el fichero de datos se compacta cuando la mitad son huecos.
+class DeepSeekResponseCache
+{
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        int entries = 0;
+        qint64 liveBytes = 0;
+    };
+
+    DeepSeekResponseCache();
+    ~DeepSeekResponseCache();
+
+    bool open(const QString &directory);
+    void close();
+    bool isOpen() const { return m_data.isOpen(); }
+
+    void setMaxSize(qint64 bytes);
+    qint64 maxSize() const { return m_maxBytes; }
+
+    static QByteArray keyFor(const QByteArray &canonicalRequest);
+
+    bool lookup(const QByteArray &key, QString *content);
+    void insert(const QByteArray &key, const QString &content);
+
+    void flush();
+    Stats stats() const;
+
+private:
+    struct Entry {
+        quint64 offset = 0;     // inicio del registro en responses.dat
+        quint32 length = 0;     // bytes del valor (UTF-8)
+        quint64 lastUsed = 0;   // reloj lógico para LRU
+    };
+
+    bool loadIndex(qint64 *indexedDataSize);
+    void recoverTail(qint64 from);
+    bool writeIndex();
+    void evictToFit();
+    void compact();
+    qint64 recordSize(const Entry &entry) const;
+
+    QString m_directory;
+    QFile m_data;
+    QHash<QByteArray, Entry> m_entries;
+    quint64 m_clock = 0;
+    qint64 m_maxBytes = 64 * 1024 * 1024;
+    qint64 m_liveBytes = 0;
+    qint64 m_deadBytes = 0;
+    int m_unsavedChanges = 0;
+    Stats m_stats;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
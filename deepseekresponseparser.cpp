@@ -0,0 +1,516 @@
+#include "deepseekresponseparser.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Recorre el JSON una vez. Solo decodifica las cadenas y números que se
+// piden; todo lo demás se salta contando llaves y corchetes.
+class Scanner
+{
+public:
+    explicit Scanner(QByteArrayView json)
+        : m_p(json.data()),
+          m_end(json.data() + json.size())
+    {}
+
+    DeepSeekResponseParser::Status parseRoot(ChatCompletionResult *result)
+    {
+        const bool ok = parseObject([&](QByteArrayView key) {
+            if (key == "choices") {
+                result->hasChoices = true;
+                return parseArray([&](int index) {
+                    return index == 0 ? parseChoice(result) : skipValue();
+                });
+            }
+            if (key == "usage")
+                return parseUsage(&result->usage);
+            if (key == "error")
+                return parseError(result);
+            return skipValue();
+        });
+
+        if (ok) {
+            while (m_p < m_end && isSpace(*m_p))
+                ++m_p;
+            if (m_p != m_end)
+                m_malformed = true;
+        }
+
+        if (m_malformed)
+            return DeepSeekResponseParser::Malformed;
+        if (m_incomplete || !ok)
+            return DeepSeekResponseParser::Incomplete;
+        return DeepSeekResponseParser::Complete;
+    }
+
+private:
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    bool fail()
+    {
+        m_malformed = true;
+        return false;
+    }
+
+    bool endOfInput()
+    {
+        m_incomplete = true;
+        return false;
+    }
+
+    bool skipSpace()
+    {
+        while (m_p < m_end && isSpace(*m_p))
+            ++m_p;
+        return m_p < m_end || endOfInput();
+    }
+
+    bool expect(char c)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p != c)
+            return fail();
+        ++m_p;
+        return true;
+    }
+
+    // Deja m_p detrás de la comilla de cierre y devuelve su posición
+    const char *findStringEnd()
+    {
+        const char *from = m_p;
+        for (;;) {
+            const auto *quote = static_cast<const char *>(
+                std::memchr(from, '"', size_t(m_end - from)));
+            if (!quote) {
+                endOfInput();
+                return nullptr;
+            }
+
+            // Comilla escapada si la precede un número impar de barras
+            qsizetype backslashes = 0;
+            for (const char *r = quote - 1; r >= m_p && *r == '\\'; --r)
+                ++backslashes;
+            from = quote + 1;
+            if (backslashes % 2 == 0) {
+                m_p = from;
+                return quote;
+            }
+        }
+    }
+
+    bool skipString()
+    {
+        ++m_p; // comilla de apertura
+        return findStringEnd() != nullptr;
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    bool parseString(QString *out)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p != '"')
+            return fail();
+
+        const char *begin = ++m_p;
+        const char *end = findStringEnd();
+        if (!end)
+            return false;
+
+        const auto *firstEscape = static_cast<const char *>(
+            std::memchr(begin, '\\', size_t(end - begin)));
+        if (!firstEscape) {
+            *out = QString::fromUtf8(begin, end - begin);
+            return true;
+        }
+
+        QString decoded;
+        decoded.reserve(end - begin);
+        const char *p = begin;
+        while (p < end) {
+            const auto *escape = static_cast<const char *>(
+                std::memchr(p, '\\', size_t(end - p)));
+            if (!escape) {
+                decoded += QString::fromUtf8(p, end - p);
+                break;
+            }
+            if (escape > p)
+                decoded += QString::fromUtf8(p, escape - p);
+            if (escape + 1 >= end)
+                return fail();
+
+            p = escape + 2;
+            switch (escape[1]) {
+            case '"': decoded += QLatin1Char('"'); break;
+            case '\\': decoded += QLatin1Char('\\'); break;
+            case '/': decoded += QLatin1Char('/'); break;
+            case 'b': decoded += QLatin1Char('\b'); break;
+            case 'f': decoded += QLatin1Char('\f'); break;
+            case 'n': decoded += QLatin1Char('\n'); break;
+            case 'r': decoded += QLatin1Char('\r'); break;
+            case 't': decoded += QLatin1Char('\t'); break;
+            case 'u': {
+                if (end - p < 4)
+                    return fail();
+                char16_t unit = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = hexValue(p[i]);
+                    if (digit < 0)
+                        return fail();
+                    unit = char16_t((unit << 4) | digit);
+                }
+                // Los pares surrogate llegan como dos \u seguidos
+                decoded += QChar(unit);
+                p += 4;
+                break;
+            }
+            default:
+                return fail();
+            }
+        }
+
+        *out = decoded;
+        return true;
+    }
+
+    // Cadena, número o literal como texto (p.ej. "code" puede ser 400 o "invalid_request")
+    bool parseScalarAsString(QString *out)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p == '"')
+            return parseString(out);
+        if (*m_p == '{' || *m_p == '[')
+            return skipValue();
+
+        const char *begin = m_p;
+        while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isSpace(*m_p))
+            ++m_p;
+        if (m_p == m_end)
+            return endOfInput();
+        const QByteArrayView token(begin, m_p - begin);
+        if (token != "null")
+            *out = QString::fromLatin1(token);
+        return true;
+    }
+
+    bool parseInteger(qint64 *out)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p == '"' || *m_p == '{' || *m_p == '[')
+            return skipValue();
+
+        const char *begin = m_p;
+        bool negative = false;
+        if (*m_p == '-') {
+            negative = true;
+            ++m_p;
+        }
+
+        qint64 value = 0;
+        bool digits = false;
+        while (m_p < m_end && *m_p >= '0' && *m_p <= '9') {
+            value = value * 10 + (*m_p - '0');
+            digits = true;
+            ++m_p;
+        }
+        // Decimales, exponente o literales: se saltan
+        while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isSpace(*m_p))
+            ++m_p;
+        if (m_p == m_end)
+            return endOfInput();
+
+        if (digits)
+            *out = negative ? -value : value;
+        else if (QByteArrayView(begin, m_p - begin) != "null")
+            return fail();
+        return true;
+    }
+
+    bool skipValue()
+    {
+        if (!skipSpace())
+            return false;
+
+        switch (*m_p) {
+        case '"':
+            return skipString();
+        case '{':
+        case '[': {
+            int depth = 0;
+            while (m_p < m_end) {
+                const char c = *m_p;
+                if (c == '"') {
+                    if (!skipString())
+                        return false;
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        ++m_p;
+                        return true;
+                    }
+                }
+                ++m_p;
+            }
+            return endOfInput();
+        }
+        default:
+            while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isSpace(*m_p))
+                ++m_p;
+            return m_p < m_end || endOfInput();
+        }
+    }
+
+    template<typename OnKey>
+    bool parseObject(OnKey onKey)
+    {
+        if (!expect('{'))
+            return false;
+        if (!skipSpace())
+            return false;
+        if (*m_p == '}') {
+            ++m_p;
+            return true;
+        }
+
+        for (;;) {
+            if (!skipSpace())
+                return false;
+            if (*m_p != '"')
+                return fail();
+
+            // Las claves de la API no llevan escapes: se comparan en bruto
+            const char *keyBegin = ++m_p;
+            const char *keyEnd = findStringEnd();
+            if (!keyEnd)
+                return false;
+            if (!expect(':'))
+                return false;
+            if (!onKey(QByteArrayView(keyBegin, keyEnd - keyBegin)))
+                return false;
+
+            if (!skipSpace())
+                return false;
+            if (*m_p == ',') {
+                ++m_p;
+                continue;
+            }
+            if (*m_p == '}') {
+                ++m_p;
+                return true;
+            }
+            return fail();
+        }
+    }
+
+    template<typename OnElement>
+    bool parseArray(OnElement onElement)
+    {
+        if (!expect('['))
+            return false;
+        if (!skipSpace())
+            return false;
+        if (*m_p == ']') {
+            ++m_p;
+            return true;
+        }
+
+        for (int index = 0;; ++index) {
+            if (!onElement(index))
+                return false;
+            if (!skipSpace())
+                return false;
+            if (*m_p == ',') {
+                ++m_p;
+                continue;
+            }
+            if (*m_p == ']') {
+                ++m_p;
+                return true;
+            }
+            return fail();
+        }
+    }
+
+    bool parseChoice(ChatCompletionResult *result)
+    {
+        auto parseMessage = [&](QByteArrayView key) {
+            if (key == "content")
+                return parseScalarAsString(&result->content);
+            return skipValue();
+        };
+
+        return parseObject([&](QByteArrayView key) {
+            if (key == "message" || key == "delta") {
+                if (!skipSpace())
+                    return false;
+                return *m_p == '{' ? parseObject(parseMessage) : skipValue();
+            }
+            if (key == "text")
+                return parseScalarAsString(&result->content);
+            if (key == "finish_reason")
+                return parseScalarAsString(&result->finishReason);
+            return skipValue();
+        });
+    }
+
+    bool parseUsage(ChatCompletionUsage *usage)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p != '{')
+            return skipValue();
+
+        return parseObject([&](QByteArrayView key) {
+            if (key == "prompt_tokens")
+                return parseInteger(&usage->promptTokens);
+            if (key == "completion_tokens")
+                return parseInteger(&usage->completionTokens);
+            if (key == "total_tokens")
+                return parseInteger(&usage->totalTokens);
+            if (key == "prompt_cache_hit_tokens")
+                return parseInteger(&usage->promptCacheHitTokens);
+            if (key == "prompt_cache_miss_tokens")
+                return parseInteger(&usage->promptCacheMissTokens);
+            return skipValue();
+        });
+    }
+
+    bool parseError(ChatCompletionResult *result)
+    {
+        if (!skipSpace())
+            return false;
+        if (*m_p == 'n')
+            return skipValue(); // "error": null
+
+        result->hasError = true;
+        if (*m_p == '"')
+            return parseString(&result->errorMessage);
+        if (*m_p != '{')
+            return skipValue();
+
+        return parseObject([&](QByteArrayView key) {
+            if (key == "message")
+                return parseScalarAsString(&result->errorMessage);
+            if (key == "type")
+                return parseScalarAsString(&result->errorType);
+            if (key == "code")
+                return parseScalarAsString(&result->errorCode);
+            return skipValue();
+        });
+    }
+
+    const char *m_p;
+    const char *m_end;
+    bool m_incomplete = false;
+    bool m_malformed = false;
+};
+
+QString scalarToString(const QJsonValue &value)
+{
+    if (value.isString())
+        return value.toString();
+    if (value.isDouble())
+        return QString::number(value.toInteger());
+    return QString();
+}
+
+} // namespace
+
+DeepSeekResponseParser::Status DeepSeekResponseParser::parse(QByteArrayView json,
+                                                             ChatCompletionResult *result)
+{
+    Scanner scanner(json);
+    return scanner.parseRoot(result);
+}
+
+bool DeepSeekResponseParser::parseWithFallback(QByteArrayView json, ChatCompletionResult *result)
+{
+    ChatCompletionResult scanned;
+    const Status status = parse(json, &scanned);
+    if (status == Complete) {
+        *result = scanned;
+        return true;
+    }
+
+    if (status == Malformed && parseWithDom(json, result))
+        return true;
+
+    *result = scanned;
+    return false;
+}
+
+bool DeepSeekResponseParser::parseWithDom(QByteArrayView json, ChatCompletionResult *result)
+{
+    const QJsonDocument doc = QJsonDocument::fromJson(json.toByteArray());
+    if (!doc.isObject())
+        return false;
+
+    const QJsonObject obj = doc.object();
+    ChatCompletionResult parsed;
+
+    // "choices":[] llega en el último evento, el que solo trae el usage:
+    // hay choices (como en el parser rápido) pero ningún contenido
+    parsed.hasChoices = obj.value("choices").isArray();
+    const QJsonArray choices = obj.value("choices").toArray();
+    if (!choices.isEmpty()) {
+        const QJsonObject choice = choices.first().toObject();
+        const QJsonObject message = choice.contains("message")
+                                        ? choice.value("message").toObject()
+                                        : choice.value("delta").toObject();
+        parsed.content = message.contains("content") ? scalarToString(message.value("content"))
+                                                     : scalarToString(choice.value("text"));
+        parsed.finishReason = scalarToString(choice.value("finish_reason"));
+    }
+
+    const QJsonObject usage = obj.value("usage").toObject();
+    auto tokens = [&usage](const char *key) {
+        return usage.contains(QLatin1String(key)) ? usage.value(QLatin1String(key)).toInteger(-1)
+                                                  : qint64(-1);
+    };
+    parsed.usage.promptTokens = tokens("prompt_tokens");
+    parsed.usage.completionTokens = tokens("completion_tokens");
+    parsed.usage.totalTokens = tokens("total_tokens");
+    parsed.usage.promptCacheHitTokens = tokens("prompt_cache_hit_tokens");
+    parsed.usage.promptCacheMissTokens = tokens("prompt_cache_miss_tokens");
+
+    const QJsonValue error = obj.value("error");
+    if (error.isObject()) {
+        parsed.hasError = true;
+        parsed.errorMessage = scalarToString(error.toObject().value("message"));
+        parsed.errorType = scalarToString(error.toObject().value("type"));
+        parsed.errorCode = scalarToString(error.toObject().value("code"));
+    } else if (error.isString()) {
+        parsed.hasError = true;
+        parsed.errorMessage = error.toString();
+    }
+
+    *result = parsed;
+    return true;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+struct ChatCompletionUsage
+{
+    qint64 promptTokens = -1;
+    qint64 completionTokens = -1;
+    qint64 totalTokens = -1;
+    qint64 promptCacheHitTokens = -1;
+    qint64 promptCacheMissTokens = -1;
+
+    bool isValid() const { return totalTokens >= 0 || promptTokens >= 0; }
+};
+
+// Campos que usa el plugin de una respuesta de /chat/completions, tanto de
+// la respuesta completa (choices[0].message) como de un evento de streaming
+// (choices[0].delta) o de /completions (choices[0].text).
+struct ChatCompletionResult
+{
+    QString content;
+    QString finishReason;
+    ChatCompletionUsage usage;
+    bool hasChoices = false;
+
+    bool hasError = false;
+    QString errorMessage;
+    QString errorType;
+    QString errorCode;
+};
+
+// Extrae esos campos recorriendo los bytes una sola vez, sin construir un
+// QJsonDocument: el resto del documento se salta sin decodificar. Si la
+// entrada se corta a mitad, devuelve Incomplete con lo extraído hasta ese
+// punto; si no es JSON válido devuelve Malformed.
+class DeepSeekResponseParser
+{
+public:
+    enum Status {
+        Complete,
+        Incomplete,
+        Malformed
+    };
+
+    static Status parse(QByteArrayView json, ChatCompletionResult *result);
+
+    // parse() y, si los datos están malformados, QJsonDocument como respaldo.
+    // Devuelve true si el documento se pudo leer completo.
+    static bool parseWithFallback(QByteArrayView json, ChatCompletionResult *result);
+
+private:
+    static bool parseWithDom(QByteArrayView json, ChatCompletionResult *result);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,453 @@
+#include "deepseeksearchindex.h"
+#include "deepseekcodechunker.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Líneas por documento: lo bastante para dar contexto, poco para no gastar
+// el presupuesto de tokens en una sola coincidencia
+const int kWindowLines = 40;
+// Unidades más largas que esto se cortan en ventanas de kWindowLines
+const int kMaxUnitLines = 2 * kWindowLines;
+// Términos de la consulta que se puntúan (los de mayor idf)
+const int kMaxQueryTerms = 32;
+const int kMaxTermLength = 64;
+// Capas a partir de las cuales compensa reconstruir el índice entero
+const int kMaxLayers = 16;
+
+// Parámetros habituales de BM25
+const double kK1 = 1.2;
+const double kB = 0.75;
+
+inline bool isIdentStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isIdent(char c)
+{
+    return isIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+inline bool isUpper(char c) { return c >= 'A' && c <= 'Z'; }
+inline bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+inline char toLower(char c) { return isUpper(c) ? char(c + ('a' - 'A')) : c; }
+
+bool isStopWord(QByteArrayView term)
+{
+    // Palabras clave y ruido de Qt/C++ que aparecen en casi todos los ficheros
+    static const QSet<QByteArray> words = {
+        "auto", "bool", "break", "case", "char", "class", "const", "continue", "default",
+        "delete", "do", "double", "else", "emit", "enum", "explicit", "false", "float",
+        "for", "if", "include", "int", "namespace", "new", "nullptr", "override", "private",
+        "protected", "public", "return", "signals", "slots", "static", "std", "struct",
+        "switch", "this", "true", "typename", "using", "void", "while", "qt", "the", "and",
+        "or", "of", "to", "in", "is", "it", "an", "be", "property", "import", "id"};
+    return words.contains(QByteArray::fromRawData(term.data(), term.size()));
+}
+
+// Llama a onTerm(term) con cada término de text: el identificador completo en
+// minúsculas y, si es compuesto, cada una de sus partes
+template<typename OnTerm>
+void forEachTerm(QByteArrayView text, OnTerm onTerm)
+{
+    char lower[kMaxTermLength];
+    const char *p = text.data();
+    const char *const end = p + text.size();
+
+    while (p < end) {
+        if (!isIdentStart(*p)) {
+            // Números y literales numéricos no se indexan
+            if (*p >= '0' && *p <= '9') {
+                while (p < end && isIdent(*p))
+                    ++p;
+            } else {
+                ++p;
+            }
+            continue;
+        }
+
+        const char *start = p;
+        while (p < end && isIdent(*p))
+            ++p;
+        const int length = int(p - start);
+        if (length < 2 || length > kMaxTermLength)
+            continue;
+
+        for (int i = 0; i < length; ++i)
+            lower[i] = toLower(start[i]);
+        const QByteArrayView whole(lower, length);
+        if (!isStopWord(whole))
+            onTerm(whole);
+
+        // Partes: requestFix -> request, fix; HTTPServer -> http, server;
+        // m_chunk_tokens -> chunk, tokens
+        int partStart = 0;
+        int parts = 0;
+        auto flushPart = [&](int partEnd) {
+            while (partStart < partEnd && start[partStart] == '_')
+                ++partStart;
+            if (partEnd - partStart >= 2 && !(partStart == 0 && partEnd == length)) {
+                const QByteArrayView part(lower + partStart, partEnd - partStart);
+                if (!isStopWord(part))
+                    onTerm(part);
+            }
+            ++parts;
+            partStart = partEnd;
+        };
+        for (int i = 1; i < length; ++i) {
+            const char prev = start[i - 1];
+            const char c = start[i];
+            if (c == '_'
+                || (isUpper(c) && isLower(prev))
+                || (isUpper(c) && isUpper(prev) && i + 1 < length && isLower(start[i + 1]))) {
+                flushPart(i);
+            }
+        }
+        if (parts > 0)
+            flushPart(length);
+    }
+}
+
+} // namespace
+
+quint32 DeepSeekSearchIndex::termId(QByteArrayView term)
+{
+    // Búsqueda sin copiar; solo se copia el término la primera vez
+    const QByteArray key = QByteArray::fromRawData(term.data(), term.size());
+    const auto it = m_terms.constFind(key);
+    if (it != m_terms.cend())
+        return it.value();
+
+    const quint32 id = quint32(m_postings.size());
+    m_terms.insert(QByteArray(term.data(), term.size()), id);
+    m_postings.append(QList<Posting>());
+    return id;
+}
+
+void DeepSeekSearchIndex::build(DeepSeekProjectSnapshot::Pointer snapshot)
+{
+    addLayer(std::move(snapshot));
+    updateAverageLength();
+
+    m_scratch.clear();
+    m_scratch.squeeze();
+    for (QList<Posting> &postings : m_postings)
+        postings.squeeze();
+}
+
+std::shared_ptr<DeepSeekSearchIndex> DeepSeekSearchIndex::updated(
+    DeepSeekProjectSnapshot::Pointer changes, const QStringList &removedPaths) const
+{
+    // La copia comparte todas las listas; solo se desdoblan las que se tocan
+    auto index = std::make_shared<DeepSeekSearchIndex>(*this);
+    for (const QString &path : removedPaths)
+        index->removeFile(path);
+    for (int file = 0; file < changes->fileCount(); ++file)
+        index->removeFile(changes->path(file));
+    if (changes->fileCount() > 0)
+        index->addLayer(std::move(changes));
+    index->updateAverageLength();
+    index->m_scratch.clear();
+    index->m_scratch.squeeze();
+    return index;
+}
+
+bool DeepSeekSearchIndex::needsCompaction() const
+{
+    return m_deadDocuments > m_liveDocuments / 4 || m_layers.size() > kMaxLayers;
+}
+
+DeepSeekProjectSnapshot::Pointer DeepSeekSearchIndex::compactedSnapshot() const
+{
+    DeepSeekProjectSnapshot::Builder builder;
+    qsizetype bytes = 0;
+    for (const Layer &layer : m_layers)
+        bytes += layer.snapshot->totalBytes();
+    builder.reserve(m_liveFiles, bytes);
+
+    for (const Layer &layer : m_layers) {
+        for (int i = 0; i < layer.snapshot->fileCount(); ++i) {
+            if (!m_removed.testBit(int(layer.firstFile) + i))
+                builder.addFile(layer.snapshot->path(i), layer.snapshot->content(i),
+                                layer.snapshot->mtimeMs(i));
+        }
+    }
+    return builder.build();
+}
+
+QStringList DeepSeekSearchIndex::filePaths() const
+{
+    QStringList paths;
+    paths.reserve(m_liveFiles);
+    for (const Layer &layer : m_layers) {
+        for (int i = 0; i < layer.snapshot->fileCount(); ++i) {
+            if (!m_removed.testBit(int(layer.firstFile) + i))
+                paths.append(layer.snapshot->path(i));
+        }
+    }
+    // Las capas van ordenadas por segmentos de ruta ("src/foo/b.cpp" antes
+    // que "src/foo-bar/a.cpp"), no como cadenas: siempre hay que ordenar
+    paths.sort();
+    return paths;
+}
+
+QByteArrayView DeepSeekSearchIndex::fileContent(QStringView path) const
+{
+    const int file = findFile(path);
+    return file < 0 ? QByteArrayView() : contentOf(quint32(file));
+}
+
+bool DeepSeekSearchIndex::fileState(QStringView path, qint64 *size, qint64 *mtimeMs) const
+{
+    const int file = findFile(path);
+    if (file < 0)
+        return false;
+    const Layer &layer = layerOf(quint32(file));
+    const int local = file - int(layer.firstFile);
+    if (size)
+        *size = layer.snapshot->content(local).size();
+    if (mtimeMs)
+        *mtimeMs = layer.snapshot->mtimeMs(local);
+    return true;
+}
+
+const DeepSeekSearchIndex::Layer &DeepSeekSearchIndex::layerOf(quint32 file) const
+{
+    // Última capa cuyo primer fichero no pasa de file
+    const auto it = std::upper_bound(m_layers.cbegin(), m_layers.cend(), file,
+                                     [](quint32 id, const Layer &layer) {
+                                         return id < layer.firstFile;
+                                     });
+    return *(it - 1);
+}
+
+QByteArrayView DeepSeekSearchIndex::contentOf(quint32 file) const
+{
+    const Layer &layer = layerOf(file);
+    return layer.snapshot->content(int(file - layer.firstFile));
+}
+
+QString DeepSeekSearchIndex::pathOf(quint32 file) const
+{
+    const Layer &layer = layerOf(file);
+    return layer.snapshot->path(int(file - layer.firstFile));
+}
+
+int DeepSeekSearchIndex::findFile(QStringView path) const
+{
+    // La capa más reciente que tenga la ruta manda: si ahí está borrado, el
+    // fichero ya no existe
+    for (auto it = m_layers.crbegin(); it != m_layers.crend(); ++it) {
+        const int local = it->snapshot->indexOf(path);
+        if (local < 0)
+            continue;
+        const int file = int(it->firstFile) + local;
+        return m_removed.testBit(file) ? -1 : file;
+    }
+    return -1;
+}
+
+void DeepSeekSearchIndex::removeFile(QStringView path)
+{
+    const int file = findFile(path);
+    if (file < 0)
+        return;
+
+    m_removed.setBit(file);
+    --m_liveFiles;
+    const File &entry = m_files.at(file);
+    for (quint32 i = 0; i < entry.documentCount; ++i)
+        m_liveLength -= m_documents.at(entry.firstDocument + i).length;
+    m_liveDocuments -= entry.documentCount;
+    m_deadDocuments += entry.documentCount;
+}
+
+void DeepSeekSearchIndex::addLayer(DeepSeekProjectSnapshot::Pointer snapshot)
+{
+    const quint32 firstFile = quint32(m_files.size());
+    const int count = snapshot->fileCount();
+    m_layers.append({std::move(snapshot), firstFile});
+    m_files.resize(firstFile + count);
+    m_removed.resize(int(firstFile) + count);
+    for (int i = 0; i < count; ++i)
+        addFile(firstFile + quint32(i));
+}
+
+void DeepSeekSearchIndex::addFile(quint32 file)
+{
+    // Los ficheros vacíos o enormes siguen en el índice, sin documentos
+    ++m_liveFiles;
+    m_files[file].firstDocument = quint32(m_documents.size());
+
+    const QByteArrayView content = contentOf(file);
+    if (content.isEmpty() || content.size() > MaxFileBytes)
+        return;
+
+    // Unidades completas (clases, funciones) agrupadas hasta kWindowLines;
+    // una coincidencia devuelve así la definición entera y no media
+    const QList<DeepSeekCodeChunker::Unit> units
+        = DeepSeekCodeChunker::split(content, DeepSeekCodeChunker::languageFor(pathOf(file)),
+                                     false);
+    qsizetype begin = 0;
+    qsizetype end = 0;
+    int firstLine = 1;
+    int lines = 0;
+    auto flush = [&] {
+        if (end > begin)
+            addDocument(file, quint32(begin), quint32(end), quint32(firstLine), quint32(lines));
+        begin = end;
+        lines = 0;
+    };
+
+    for (const DeepSeekCodeChunker::Unit &unit : units) {
+        if (lines > 0 && lines + unit.lineCount > kWindowLines)
+            flush();
+        if (unit.lineCount > kMaxUnitLines) {
+            flush();
+            addWindows(file, unit.begin, unit.end, unit.firstLine);
+            begin = end = unit.end;
+            continue;
+        }
+        if (lines == 0)
+            firstLine = unit.firstLine;
+        end = unit.end;
+        lines = unit.firstLine + unit.lineCount - firstLine;
+    }
+    flush();
+}
+
+void DeepSeekSearchIndex::addWindows(quint32 file, qsizetype begin, qsizetype end, int firstLine)
+{
+    const char *const data = contentOf(file).data();
+    quint32 line = quint32(firstLine);
+
+    while (begin < end) {
+        qsizetype windowEnd = begin;
+        int lines = 0;
+        while (windowEnd < end && lines < kWindowLines) {
+            const void *newline = std::memchr(data + windowEnd, '\n', size_t(end - windowEnd));
+            windowEnd = newline ? static_cast<const char *>(newline) - data + 1 : end;
+            ++lines;
+        }
+        addDocument(file, quint32(begin), quint32(windowEnd), line, quint32(lines));
+        line += quint32(lines);
+        begin = windowEnd;
+    }
+}
+
+void DeepSeekSearchIndex::addDocument(quint32 file, quint32 begin, quint32 end,
+                                      quint32 firstLine, quint32 lineCount)
+{
+    m_scratch.clear();
+    forEachTerm(contentOf(file).sliced(begin, end - begin),
+                [this](QByteArrayView term) { m_scratch.append(termId(term)); });
+    if (m_scratch.isEmpty())
+        return;
+
+    const quint32 document = quint32(m_documents.size());
+    const quint32 length = quint32(m_scratch.size());
+    m_documents.append({file, begin, end, firstLine, lineCount, length});
+    ++m_files[file].documentCount;
+    ++m_liveDocuments;
+    m_liveLength += length;
+
+    // Frecuencias: términos ordenados y contados por tramos
+    std::sort(m_scratch.begin(), m_scratch.end());
+    for (qsizetype i = 0; i < m_scratch.size();) {
+        qsizetype j = i + 1;
+        while (j < m_scratch.size() && m_scratch.at(j) == m_scratch.at(i))
+            ++j;
+        m_postings[m_scratch.at(i)].append({document, quint32(j - i)});
+        i = j;
+    }
+}
+
+void DeepSeekSearchIndex::updateAverageLength()
+{
+    m_averageLength = m_liveDocuments == 0 ? 1.0 : double(m_liveLength) / m_liveDocuments;
+}
+
+QList<DeepSeekSearchIndex::Hit> DeepSeekSearchIndex::search(QStringView query, int maxHits) const
+{
+    if (m_liveDocuments == 0 || maxHits <= 0)
+        return {};
+
+    // 1. Términos de la consulta presentes en el índice, sin repetir
+    QList<quint32> terms;
+    QSet<quint32> seen;
+    forEachTerm(query.toUtf8(), [this, &terms, &seen](QByteArrayView term) {
+        const auto it = m_terms.constFind(QByteArray::fromRawData(term.data(), term.size()));
+        if (it != m_terms.cend() && !seen.contains(it.value())) {
+            seen.insert(it.value());
+            terms.append(it.value());
+        }
+    });
+    if (terms.isEmpty())
+        return {};
+
+    // 2. Los más discriminantes primero; una consulta larga (código entero
+    //    en modo fix) no debe recorrer las listas de los términos comunes.
+    //    Las listas incluyen documentos borrados hasta la compactación, así
+    //    que N cuenta todos para que df no lo supere
+    const double n = double(m_documents.size());
+    auto idf = [this, n](quint32 term) {
+        const double df = double(m_postings.at(term).size());
+        return std::log(1.0 + (n - df + 0.5) / (df + 0.5));
+    };
+    std::sort(terms.begin(), terms.end(), [&](quint32 a, quint32 b) {
+        return m_postings.at(a).size() < m_postings.at(b).size();
+    });
+    if (terms.size() > kMaxQueryTerms)
+        terms.resize(kMaxQueryTerms);
+
+    // 3. Acumulación BM25
+    QList<float> scores(m_documents.size(), 0.0f);
+    QList<quint32> touched;
+    const bool hasRemoved = m_deadDocuments > 0;
+    for (quint32 term : std::as_const(terms)) {
+        const double weight = idf(term);
+        for (const Posting &posting : m_postings.at(term)) {
+            const Document &document = m_documents.at(posting.document);
+            if (hasRemoved && m_removed.testBit(int(document.file)))
+                continue;
+            const double tf = posting.frequency;
+            const double norm = kK1 * (1.0 - kB + kB * document.length / m_averageLength);
+            float &score = scores[posting.document];
+            if (score == 0.0f)
+                touched.append(posting.document);
+            score += float(weight * tf * (kK1 + 1.0) / (tf + norm));
+        }
+    }
+
+    // 4. Los k mejores
+    const qsizetype count = qMin<qsizetype>(maxHits, touched.size());
+    std::partial_sort(touched.begin(), touched.begin() + count, touched.end(),
+                      [&scores](quint32 a, quint32 b) { return scores.at(a) > scores.at(b); });
+
+    QList<Hit> hits;
+    hits.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        const Document &document = m_documents.at(touched.at(i));
+        const QByteArrayView content = contentOf(document.file);
+        Hit hit;
+        hit.path = pathOf(document.file);
+        hit.firstLine = int(document.firstLine);
+        hit.lastLine = int(document.firstLine + document.lineCount - 1);
+        hit.score = scores.at(touched.at(i));
+        hit.text = QString::fromUtf8(content.sliced(document.begin, document.end - document.begin));
+        hits.append(hit);
+    }
+    return hits;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
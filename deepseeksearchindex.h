@@ -0,0 +1,125 @@
+#pragma once
+
+#include "deepseekprojectsnapshot.h"
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Índice invertido BM25 sobre los ficheros de un proyecto.
+//
+// Cada fichero se corta en documentos de unas 40 líneas hechos de clases y
+// funciones completas (DeepSeekCodeChunker) y de cada documento se indexan
+// los identificadores en minúsculas, enteros y partidos por
+// camelCase/snake_case. Las listas de apariciones guardan
+// (documento, frecuencia). Se construye con build() sobre un
+// DeepSeekProjectSnapshot, que el índice mantiene vivo y del que salen los
+// textos de los resultados sin copiarlos; después es de solo lectura:
+// search() es const y se puede llamar desde cualquier hilo.
+//
+// updated() devuelve un índice nuevo con unos pocos ficheros cambiados sin
+// reconstruir el resto: los ficheros nuevos van en una capa (un snapshot
+// propio) y los sustituidos quedan marcados como borrados, con sus
+// documentos ignorados en search(). Las listas no tocadas se comparten con
+// el índice anterior (copia implícita de Qt). Cuando los documentos
+// muertos pesan demasiado, needsCompaction() pide reconstruirlo entero
+// desde compactedSnapshot().
+class DeepSeekSearchIndex
+{
+public:
+    struct Hit {
+        QString path;
+        int firstLine = 0;    // 1-based
+        int lastLine = 0;
+        float score = 0.0f;
+        QString text;
+    };
+
+    // Ficheros mayores que esto suelen ser generados y se ignoran
+    static constexpr qsizetype MaxFileBytes = 1024 * 1024;
+
+    void build(DeepSeekProjectSnapshot::Pointer snapshot);
+
+    // changes: contenido nuevo de ficheros añadidos o modificados
+    std::shared_ptr<DeepSeekSearchIndex> updated(DeepSeekProjectSnapshot::Pointer changes,
+                                                 const QStringList &removedPaths) const;
+    bool needsCompaction() const;
+    // Los ficheros vivos de todas las capas en un solo snapshot
+    DeepSeekProjectSnapshot::Pointer compactedSnapshot() const;
+
+    QList<Hit> search(QStringView query, int maxHits) const;
+
+    // Rutas de los ficheros vivos, en el orden de QStringList::sort()
+    QStringList filePaths() const;
+    // Vacío si el fichero no está; la vista vive lo que viva el índice
+    QByteArrayView fileContent(QStringView path) const;
+    bool fileState(QStringView path, qint64 *size, qint64 *mtimeMs) const;
+
+    int fileCount() const { return m_liveFiles; }
+    int documentCount() const { return int(m_liveDocuments); }
+    int termCount() const { return int(m_terms.size()); }
+
+private:
+    struct Layer {
+        DeepSeekProjectSnapshot::Pointer snapshot;
+        quint32 firstFile = 0;    // id del primer fichero de la capa
+    };
+
+    struct File {
+        quint32 firstDocument = 0;
+        quint32 documentCount = 0;
+    };
+
+    struct Document {
+        quint32 file = 0;
+        quint32 begin = 0;        // rango de bytes en el contenido del fichero
+        quint32 end = 0;
+        quint32 firstLine = 0;
+        quint32 lineCount = 0;
+        quint32 length = 0;       // nº de términos
+    };
+
+    struct Posting {
+        quint32 document;
+        quint32 frequency;
+    };
+
+    const Layer &layerOf(quint32 file) const;
+    QByteArrayView contentOf(quint32 file) const;
+    QString pathOf(quint32 file) const;
+    int findFile(QStringView path) const;
+    void removeFile(QStringView path);
+
+    quint32 termId(QByteArrayView term);
+    void addLayer(DeepSeekProjectSnapshot::Pointer snapshot);
+    void addFile(quint32 file);
+    void addWindows(quint32 file, qsizetype begin, qsizetype end, int firstLine);
+    void addDocument(quint32 file, quint32 begin, quint32 end, quint32 firstLine,
+                     quint32 lineCount);
+    void updateAverageLength();
+
+    QList<Layer> m_layers;
+    QList<File> m_files;          // id de fichero: firstFile de su capa + índice en ella
+    QBitArray m_removed;          // ficheros sustituidos por una capa posterior o borrados
+    QList<Document> m_documents;
+    QHash<QByteArray, quint32> m_terms;
+    QList<QList<Posting>> m_postings;
+    QList<quint32> m_scratch;     // términos del documento en construcción
+    int m_liveFiles = 0;
+    quint32 m_liveDocuments = 0;
+    quint32 m_deadDocuments = 0;
+    quint64 m_liveLength = 0;     // términos de los documentos vivos
+    double m_averageLength = 1.0;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
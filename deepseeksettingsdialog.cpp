@@ -4,6 +4,7 @@
 #include <QSettings>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QCheckBox>
 
 namespace DeepSeekAI {
 namespace Internal {
@@ -20,10 +21,13 @@ DeepSeekSettingsDialog::DeepSeekSettingsDialog(QWidget *parent) :
 
     // Cargar la API Key existente
     ui->apiKeyLineEdit->setText(loadApiKey());
+    ui->streamingCheckBox->setChecked(loadStreamingEnabled());
 
     // Conectar señales
     connect(ui->apiKeyLineEdit, &QLineEdit::textChanged,
             this, &DeepSeekSettingsDialog::onApiKeyChanged);
+    connect(ui->streamingCheckBox, &QCheckBox::toggled,
+            this, &DeepSeekSettingsDialog::onApiKeyChanged);
 
     // Configurar botones
     ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
@@ -44,6 +48,16 @@ void DeepSeekSettingsDialog::setApiKey(const QString &key)
     ui->apiKeyLineEdit->setText(key);
 }
 
+bool DeepSeekSettingsDialog::streamingEnabled() const
+{
+    return ui->streamingCheckBox->isChecked();
+}
+
+void DeepSeekSettingsDialog::setStreamingEnabled(bool enabled)
+{
+    ui->streamingCheckBox->setChecked(enabled);
+}
+
 void DeepSeekSettingsDialog::onApiKeyChanged()
 {
     bool valid = !apiKey().isEmpty();
@@ -68,5 +82,23 @@ void DeepSeekSettingsDialog::saveApiKey(const QString &key)
     settings.endGroup();
 }
 
+bool DeepSeekSettingsDialog::loadStreamingEnabled()
+{
+    QSettings settings;
+    settings.beginGroup("DeepSeekPlugin");
+    bool enabled = settings.value("Streaming", true).toBool();
+    settings.endGroup();
+
+    return enabled;
+}
+
+void DeepSeekSettingsDialog::saveStreamingEnabled(bool enabled)
+{
+    QSettings settings;
+    settings.beginGroup("DeepSeekPlugin");
+    settings.setValue("Streaming", enabled);
+    settings.endGroup();
+}
+
 } // namespace Internal
 } // namespace DeepSeekAI
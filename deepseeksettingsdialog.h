@@ -19,9 +19,13 @@ public:
 
     QString apiKey() const;
     void setApiKey(const QString &key);
+    bool streamingEnabled() const;
+    void setStreamingEnabled(bool enabled);
 
     static QString loadApiKey();
     static void saveApiKey(const QString &key);
+    static bool loadStreamingEnabled();
+    static void saveStreamingEnabled(bool enabled);
 
 private slots:
     void onApiKeyChanged();
@@ -0,0 +1,76 @@
+#include "deepseekstreamparser.h"
+
+namespace DeepSeekAI {
+namespace Internal {
+
+QList<QByteArray> DeepSeekStreamParser::feed(const QByteArray &chunk)
+{
+    m_buffer.append(chunk);
+    return takeEvents(false);
+}
+
+QList<QByteArray> DeepSeekStreamParser::flush()
+{
+    return takeEvents(true);
+}
+
+void DeepSeekStreamParser::reset()
+{
+    m_buffer.clear();
+    m_pendingData.clear();
+    m_done = false;
+}
+
+QList<QByteArray> DeepSeekStreamParser::takeEvents(bool atEnd)
+{
+    QList<QByteArray> events;
+
+    auto dispatch = [&]() {
+        if (m_pendingData.isEmpty())
+            return;
+        if (m_pendingData == "[DONE]")
+            m_done = true;
+        else
+            events.append(m_pendingData);
+        m_pendingData.clear();
+    };
+
+    qsizetype lineStart = 0;
+    while (lineStart < m_buffer.size()) {
+        qsizetype lineEnd = m_buffer.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            if (!atEnd)
+                break;
+            lineEnd = m_buffer.size();
+        }
+
+        QByteArrayView line(m_buffer.constData() + lineStart, lineEnd - lineStart);
+        if (line.endsWith('\r'))
+            line.chop(1);
+
+        if (line.isEmpty()) {
+            // Línea en blanco: fin del evento
+            dispatch();
+        } else if (line.startsWith("data:")) {
+            QByteArrayView value = line.sliced(5);
+            if (value.startsWith(' '))
+                value = value.sliced(1);
+            if (!m_pendingData.isEmpty())
+                m_pendingData.append('\n');
+            m_pendingData.append(value);
+        }
+        // Se ignoran comentarios (": keep-alive") y los campos event:/id:/retry:
+
+        lineStart = lineEnd + 1;
+    }
+
+    m_buffer.remove(0, qMin(lineStart, m_buffer.size()));
+
+    if (atEnd)
+        dispatch();
+
+    return events;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Separa un flujo text/event-stream (SSE) en eventos completos.
+// Los datos llegan en fragmentos arbitrarios desde QNetworkReply::readyRead,
+// así que las líneas incompletas se guardan hasta el siguiente feed().
+class DeepSeekStreamParser
+{
+public:
+    // Devuelve el contenido de cada campo "data:" completo recibido hasta ahora.
+    QList<QByteArray> feed(const QByteArray &chunk);
+
+    // Procesa lo que quede en el buffer cuando la respuesta termina.
+    QList<QByteArray> flush();
+
+    bool isDone() const { return m_done; }
+    void reset();
+
+private:
+    QList<QByteArray> takeEvents(bool atEnd);
+
+    QByteArray m_buffer;
+    QByteArray m_pendingData;
+    bool m_done = false;
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
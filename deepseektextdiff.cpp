@@ -0,0 +1,216 @@
+#include "deepseektextdiff.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <utility>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+// Líneas con su '\n' (la última puede no tenerlo)
+QList<QStringView> splitLines(QStringView text)
+{
+    QList<QStringView> lines;
+    qsizetype start = 0;
+    while (start < text.size()) {
+        const qsizetype newline = text.indexOf(u'\n', start);
+        const qsizetype end = newline < 0 ? text.size() : newline + 1;
+        lines.append(text.sliced(start, end - start));
+        start = end;
+    }
+    return lines;
+}
+
+// Pares (línea de a, línea de b) iguales de una secuencia común máxima, en
+// orden; vacío con found = false si hacen falta más de maxEdits cambios
+QList<std::pair<int, int>> commonLines(const QList<int> &a, const QList<int> &b, int maxEdits,
+                                       bool *found)
+{
+    const int n = int(a.size());
+    const int m = int(b.size());
+    const int maxD = std::min(n + m, maxEdits);
+
+    // Myers: v[k] es la x más lejana en la diagonal k; se guarda la franja
+    // [-d, d] de cada paso para reconstruir el camino
+    QList<int> v(2 * maxD + 3, 0);
+    const int offset = maxD + 1;
+    QList<QList<int>> trace;
+    int finalD = -1;
+
+    for (int d = 0; d <= maxD && finalD < 0; ++d) {
+        trace.append(v.mid(offset - d, 2 * d + 1));
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v.at(offset + k - 1) < v.at(offset + k + 1)))
+                        ? v.at(offset + k + 1)
+                        : v.at(offset + k - 1) + 1;
+            int y = x - k;
+            while (x < n && y < m && a.at(x) == b.at(y)) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                finalD = d;
+                break;
+            }
+        }
+    }
+
+    *found = finalD >= 0;
+    if (!*found)
+        return {};
+
+    // Hacia atrás: cada paso d es un movimiento (una línea borrada o
+    // insertada) seguido de una diagonal de líneas iguales
+    QList<std::pair<int, int>> matches;
+    int x = n;
+    int y = m;
+    for (int d = finalD; d >= 0; --d) {
+        const QList<int> &saved = trace.at(d);
+        auto at = [&saved, d](int k) { return saved.at(k + d); };
+        const int k = x - y;
+        int snakeStart = 0;
+        int prevX = 0;
+        int prevY = 0;
+        if (d > 0) {
+            const bool down = k == -d || (k != d && at(k - 1) < at(k + 1));
+            const int prevK = down ? k + 1 : k - 1;
+            prevX = at(prevK);
+            prevY = prevX - prevK;
+            snakeStart = down ? prevX : prevX + 1;
+        }
+        while (x > snakeStart) {
+            --x;
+            --y;
+            matches.append({x, y});
+        }
+        x = prevX;
+        y = prevY;
+    }
+    std::reverse(matches.begin(), matches.end());
+    return matches;
+}
+
+// Añade la edición que convierte oldPart (en position) en newPart, sin los
+// caracteres comunes de los extremos
+void appendEdit(QList<DeepSeekTextDiff::Edit> *edits, int position, QStringView oldPart,
+                QStringView newPart)
+{
+    qsizetype prefix = 0;
+    const qsizetype shorter = std::min(oldPart.size(), newPart.size());
+    while (prefix < shorter && oldPart.at(prefix) == newPart.at(prefix))
+        ++prefix;
+    qsizetype suffix = 0;
+    while (suffix < shorter - prefix
+           && oldPart.at(oldPart.size() - 1 - suffix) == newPart.at(newPart.size() - 1 - suffix)) {
+        ++suffix;
+    }
+    if (prefix + suffix == oldPart.size() && prefix + suffix == newPart.size())
+        return;
+
+    DeepSeekTextDiff::Edit edit;
+    edit.position = position + int(prefix);
+    edit.length = int(oldPart.size() - prefix - suffix);
+    edit.text = newPart.sliced(prefix, newPart.size() - prefix - suffix).toString();
+    edits->append(edit);
+}
+
+} // namespace
+
+QList<DeepSeekTextDiff::Edit> DeepSeekTextDiff::compute(QStringView oldText, QStringView newText)
+{
+    const QList<QStringView> oldLines = splitLines(oldText);
+    const QList<QStringView> newLines = splitLines(newText);
+
+    // Líneas comunes al principio y al final: lo normal en una corrección
+    int first = 0;
+    while (first < oldLines.size() && first < newLines.size()
+           && oldLines.at(first) == newLines.at(first)) {
+        ++first;
+    }
+    int oldEnd = int(oldLines.size());
+    int newEnd = int(newLines.size());
+    while (oldEnd > first && newEnd > first && oldLines.at(oldEnd - 1) == newLines.at(newEnd - 1)) {
+        --oldEnd;
+        --newEnd;
+    }
+
+    // Desplazamiento de cada línea del original
+    QList<int> oldOffsets(oldLines.size() + 1, 0);
+    for (int i = 0; i < oldLines.size(); ++i)
+        oldOffsets[i + 1] = oldOffsets.at(i) + int(oldLines.at(i).size());
+    auto newRange = [&newLines](int begin, int end) {
+        if (begin == end)
+            return QStringView();
+        const QChar *start = newLines.at(begin).data();
+        const QChar *stop = newLines.at(end - 1).data() + newLines.at(end - 1).size();
+        return QStringView(start, stop - start);
+    };
+    auto oldRange = [&oldText, &oldOffsets](int begin, int end) {
+        return oldText.sliced(oldOffsets.at(begin), oldOffsets.at(end) - oldOffsets.at(begin));
+    };
+
+    QList<Edit> edits;
+    if (first == oldEnd && first == newEnd)
+        return edits;
+
+    // Cada línea distinta como un entero: Myers compara enteros
+    QHash<QStringView, int> ids;
+    auto idsOf = [&ids](const QList<QStringView> &lines, int begin, int end) {
+        QList<int> result;
+        result.reserve(end - begin);
+        for (int i = begin; i < end; ++i) {
+            auto it = ids.constFind(lines.at(i));
+            if (it == ids.cend())
+                it = ids.insert(lines.at(i), int(ids.size()));
+            result.append(it.value());
+        }
+        return result;
+    };
+    const QList<int> a = idsOf(oldLines, first, oldEnd);
+    const QList<int> b = idsOf(newLines, first, newEnd);
+
+    bool found = false;
+    const QList<std::pair<int, int>> matches = commonLines(a, b, MaxLineEdits, &found);
+    if (!found) {
+        appendEdit(&edits, oldOffsets.at(first), oldRange(first, oldEnd), newRange(first, newEnd));
+        return edits;
+    }
+
+    // Los huecos entre líneas iguales son los bloques cambiados
+    int oldLine = first;
+    int newLine = first;
+    auto flush = [&](int oldStop, int newStop) {
+        if (oldStop > oldLine || newStop > newLine) {
+            appendEdit(&edits, oldOffsets.at(oldLine), oldRange(oldLine, oldStop),
+                       newRange(newLine, newStop));
+        }
+    };
+    for (const auto &[x, y] : matches) {
+        flush(first + x, first + y);
+        oldLine = first + x + 1;
+        newLine = first + y + 1;
+    }
+    flush(oldEnd, newEnd);
+    return edits;
+}
+
+QString DeepSeekTextDiff::apply(QStringView text, const QList<Edit> &edits)
+{
+    QString result;
+    result.reserve(text.size());
+    int position = 0;
+    for (const Edit &edit : edits) {
+        result += text.sliced(position, edit.position - position);
+        result += edit.text;
+        position = edit.position + edit.length;
+    }
+    result += text.sliced(position);
+    return result;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+// Diferencias mínimas entre dos versiones de un texto, para aplicar una
+// corrección sin reemplazar el documento entero.
+//
+// Primero por líneas (Myers, tras quitar el principio y el final comunes)
+// y después, dentro de cada bloque cambiado, se recortan los caracteres
+// comunes del principio y del final. Si las líneas distintas superan
+// MaxLineEdits se devuelve un solo bloque con todo lo que hay entre el
+// principio y el final comunes. No depende de Qt Gui: se calcula en
+// cualquier hilo.
+class DeepSeekTextDiff
+{
+public:
+    struct Edit {
+        int position = 0;    // en el texto original
+        int length = 0;      // caracteres que se sustituyen
+        QString text;
+    };
+
+    static constexpr int MaxLineEdits = 1000;
+
+    // Ordenadas por posición y sin solaparse
+    static QList<Edit> compute(QStringView oldText, QStringView newText);
+    static QString apply(QStringView text, const QList<Edit> &edits);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
@@ -0,0 +1,223 @@
+#include "deepseektokenestimator.h"
+#include "deepseekpayloadwriter.h"
+
+#include <QChar>
+
+#include <array>
+#include <climits>
+#include <cstring>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+namespace {
+
+enum CharClass : quint8 {
+    Other,
+    Space,
+    Newline,
+    Lower,
+    Upper,
+    Digit,
+    Punct
+};
+
+constexpr std::array<quint8, 128> makeClassTable()
+{
+    std::array<quint8, 128> table{};
+    for (int c = 0; c < 128; ++c) {
+        if (c == ' ' || c == '\t')
+            table[c] = Space;
+        else if (c == '\n' || c == '\r')
+            table[c] = Newline;
+        else if (c >= 'a' && c <= 'z')
+            table[c] = Lower;
+        else if (c >= 'A' && c <= 'Z')
+            table[c] = Upper;
+        else if (c >= '0' && c <= '9')
+            table[c] = Digit;
+        else if (c > ' ' && c < 127)
+            table[c] = Punct;
+        else
+            table[c] = Other;
+    }
+    return table;
+}
+
+constexpr std::array<quint8, 128> kClass = makeClassTable();
+
+inline quint8 classOf(char16_t c)
+{
+    return c < 128 ? kClass[c] : Other;
+}
+
+constexpr quint64 kLaneOnes = 0x0001000100010001ULL;
+constexpr quint64 kLaneBit7 = 0x0080 * kLaneOnes;
+
+inline quint64 loadBlock(const char16_t *p)
+{
+    quint64 w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// Cuatro unidades UTF-16 en 'a'..'z' (SWAR en 64 bits, sin acarreo entre carriles)
+inline bool isLowerBlock(const char16_t *p)
+{
+    const quint64 w = loadBlock(p);
+    if (w & 0xFF80FF80FF80FF80ULL)
+        return false;
+    return ((w + 0x1F * kLaneOnes) & kLaneBit7) == kLaneBit7     // >= 'a'
+           && ((w + 0x05 * kLaneOnes) & kLaneBit7) == 0;         // <= 'z'
+}
+
+inline bool isSpaceBlock(const char16_t *p)
+{
+    return loadBlock(p) == 0x20 * kLaneOnes;
+}
+
+inline bool isCjk(char16_t c)
+{
+    return (c >= 0x3000 && c <= 0x9FFF)     // puntuación CJK, kana, ideogramas
+           || (c >= 0xAC00 && c <= 0xD7AF)  // hangul
+           || (c >= 0xF900 && c <= 0xFAFF)
+           || (c >= 0xFF00 && c <= 0xFFEF); // formas de ancho completo
+}
+
+// Palabras cortas y comunes son un token; las largas se parten en subpalabras
+inline int wordTokens(qsizetype length)
+{
+    return length <= 7 ? 1 : int((length + 4) / 5);
+}
+
+int scan(QStringView text, int limit, qsizetype *stop)
+{
+    const char16_t *const begin = text.utf16();
+    const char16_t *const end = begin + text.size();
+    const char16_t *p = begin;
+    int total = 0;
+
+    while (p < end) {
+        const char16_t *const start = p;
+        const char16_t c = *p;
+        int tokens = 1;
+
+        if (c < 128) {
+            switch (kClass[c]) {
+            case Space: {
+                while (end - p >= 4 && isSpaceBlock(p))
+                    p += 4;
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    ++p;
+                const qsizetype n = p - start;
+                // Un espacio suelto va pegado a la palabra siguiente (" foo" es un token)
+                const quint8 next = p < end ? classOf(*p) : Other;
+                if (n == 1 && (next == Lower || next == Upper || next == Digit || next == Punct))
+                    tokens = 0;
+                else
+                    tokens = 1 + int((n - 1) / 16);
+                break;
+            }
+            case Newline:
+                while (p < end && classOf(*p) == Newline)
+                    ++p;
+                tokens = 1 + int((p - start - 1) / 2);
+                break;
+            case Lower:
+            case Upper: {
+                // Subpalabra: mayúsculas iniciales y minúsculas ("Deep", "Seek", "HTTP")
+                const char16_t *q = p;
+                while (q < end && classOf(*q) == Upper)
+                    ++q;
+                const bool lowerFollows = q < end && classOf(*q) == Lower;
+                if (q - p > 1 && lowerFollows)
+                    --q; // "HTTPServer": la última mayúscula abre "Server"
+                if (q - p > 1 || !lowerFollows) {
+                    p = q;
+                } else {
+                    p = q;
+                    while (end - p >= 4 && isLowerBlock(p))
+                        p += 4;
+                    while (p < end && classOf(*p) == Lower)
+                        ++p;
+                }
+                tokens = wordTokens(p - start);
+                break;
+            }
+            case Digit:
+                while (p < end && classOf(*p) == Digit)
+                    ++p;
+                tokens = int((p - start + 2) / 3);
+                break;
+            case Punct:
+                // "::", "->", "();" y similares suelen ser un solo token
+                while (p < end && classOf(*p) == Punct)
+                    ++p;
+                tokens = int((p - start + 1) / 2);
+                break;
+            default:
+                ++p;
+                break;
+            }
+        } else if (QChar::isHighSurrogate(c) && end - p >= 2 && QChar::isLowSurrogate(p[1])) {
+            p += 2;
+            tokens = 2; // emoji y símbolos fuera del BMP
+        } else if (isCjk(c)) {
+            ++p;
+        } else {
+            // Letras acentuadas, cirílico, griego...: unos dos caracteres por token
+            while (p < end && *p >= 128 && !isCjk(*p) && !QChar::isSurrogate(*p))
+                ++p;
+            if (p == start)
+                ++p; // surrogate suelto
+            tokens = int((p - start + 1) / 2);
+        }
+
+        if (total + tokens > limit) {
+            // Corte proporcional dentro de la pieza que ya no cabe
+            if (stop)
+                *stop = (start - begin) + (p - start) * (limit - total) / tokens;
+            return limit;
+        }
+        total += tokens;
+    }
+
+    if (stop)
+        *stop = text.size();
+    return total;
+}
+
+} // namespace
+
+int DeepSeekTokenEstimator::estimate(QStringView text)
+{
+    return scan(text, INT_MAX, nullptr);
+}
+
+int DeepSeekTokenEstimator::estimate(const ChatCompletionRequest &request)
+{
+    // Marcadores de rol y separadores de cada mensaje, más el inicio de la respuesta
+    int tokens = 3;
+    for (const ChatMessage &message : request.messages)
+        tokens += 4 + estimate(message.content);
+    return tokens;
+}
+
+qsizetype DeepSeekTokenEstimator::truncatedLength(QStringView text, int maxTokens)
+{
+    // El corte puede dejar al final una pieza que sola cuenta algo más (un
+    // espacio que iba pegado a la palabra siguiente): se ajusta hasta que cabe
+    qsizetype length = 0;
+    for (int budget = qMax(0, maxTokens); budget >= 0; --budget) {
+        scan(text, budget, &length);
+        if (length == 0 || scan(text.left(length), INT_MAX, nullptr) <= maxTokens)
+            break;
+    }
+    // No partir un par surrogate
+    if (length > 0 && length < text.size() && QChar::isHighSurrogate(text.at(length - 1).unicode()))
+        --length;
+    return length;
+}
+
+} // namespace Internal
+} // namespace DeepSeekAI
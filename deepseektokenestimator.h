@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QStringView>
+
+namespace DeepSeekAI {
+namespace Internal {
+
+struct ChatCompletionRequest;
+
+// Estimación local de tokens para dimensionar prompts sin consultar la API.
+//
+// No es el tokenizador de DeepSeek: no lleva su vocabulario ni sus fusiones.
+// Reproduce la pretokenización del tokenizador de DeepSeek (palabras
+// separadas por cambios de clase y de mayúsculas, números en grupos de
+// tres dígitos, espacios y saltos de línea agrupados, CJK carácter a
+// carácter) con una tabla de clases precalculada, y estima cada pieza por
+// su longitud. Los tramos de minúsculas y de espacios ASCII se recorren de
+// cuatro en cuatro unidades UTF-16. El resultado es aproximado y tiende a
+// sobrestimar, pero un texto poco habitual puede contar de menos: lo que
+// deba caber en el contexto se comprueba con upperBound().
+class DeepSeekTokenEstimator
+{
+public:
+    // Ventana de contexto y salida máxima de deepseek-chat
+    static constexpr int ContextTokens = 65536;
+    static constexpr int MaxOutputTokens = 8192;
+
+    static int estimate(QStringView text);
+    // Mensajes más la envoltura del formato de chat
+    static int estimate(const ChatCompletionRequest &request);
+
+    // Margen sobre una estimación para que el prompt quepa aunque se quede corta
+    static constexpr int MarginPercent = 10;
+    static constexpr int MarginTokens = 64;
+    static int upperBound(int tokens)
+    {
+        return tokens + tokens / 100 * MarginPercent + MarginTokens;
+    }
+
+    // Longitud del prefijo más largo de text que cabe en maxTokens
+    static qsizetype truncatedLength(QStringView text, int maxTokens);
+};
+
+} // namespace Internal
+} // namespace DeepSeekAI
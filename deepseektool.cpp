@@ -1,5 +1,7 @@
 #include "deepseektool.h"
 #include "deepseekpluginconstants.h"
+#include "deepseekrequest.h"
+#include "deepseektokenestimator.h"
 
 #include <QNetworkRequest>
 #include <QUrl>
@@ -10,6 +12,13 @@
 #include <QTimer>
 #include <QThread>
 #include <QInputDialog>
+#include <QStandardPaths>
+#include <QSslConfiguration>
+#include <QFile>
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
 
 #include "messagehelper.h" // Si usas el helper
 #include <coreplugin/messagemanager.h>
@@ -20,17 +29,116 @@ namespace Internal {
 DeepSeekTool::DeepSeekTool(QObject *parent)
     : QObject(parent),
       m_networkManager(new QNetworkAccessManager(this)),
+      m_scheduler(new DeepSeekRequestScheduler(m_networkManager, this)),
+      m_projectAnalyzer(new DeepSeekProjectAnalyzer(this, this)),
+      m_projectSearch(new DeepSeekProjectSearch(this)),
       m_baseUrl("https://api.deepseek.com/v1"),
-      m_isInitialized(false)
+      m_isInitialized(false),
+      m_streamingEnabled(DeepSeekSettingsDialog::loadStreamingEnabled()),
+      m_keepAliveTimer(new QTimer(this))
 {
     QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
     // m_apiKey = settings.value("DeepSeek/ApiKey").toString();
     // Cargar la API Key al iniciar
     m_apiKey = DeepSeekSettingsDialog::loadApiKey();
+
+    // Límites del planificador (sin interfaz, ajustables en QSettings)
+    QSettings limits;
+    limits.beginGroup("DeepSeekPlugin");
+    m_scheduler->setMaxConcurrentPerEndpoint(limits.value("MaxConcurrentRequests", 4).toInt());
+    m_scheduler->setRateLimit(limits.value("RequestsPerSecond", 2.0).toDouble(),
+                              limits.value("RequestBurst", 4).toInt());
+    m_scheduler->setMaxAttempts(limits.value("MaxAttempts", 4).toInt());
+    m_queueWaitWarningMs = limits.value("QueueWaitWarningMs", 1000).toInt();
+    m_contextTokens = limits.value("ContextTokens", DeepSeekTokenEstimator::ContextTokens).toInt();
+    // Permite apuntar el plugin al servidor simulado de benchmarks/
+    m_baseUrl = limits.value("BaseUrl", m_baseUrl).toString();
+    m_projectAnalyzer->setChunkTokenBudget(limits.value("AnalysisChunkTokens", 12000).toInt());
+    m_projectAnalyzer->setMaxParallelChunks(limits.value("AnalysisParallelChunks", 4).toInt());
+    // Fragmentos del proyecto que se añaden a los prompts (0 = ninguno)
+    m_retrievalSnippets = limits.value("RetrievalSnippets", 6).toInt();
+    m_retrievalTokens = limits.value("RetrievalTokens", 2000).toInt();
+    // Estructura del proyecto y ficheros fijados al principio de cada prompt
+    m_stablePromptPrefix = limits.value("StablePromptPrefix", true).toBool();
+    m_projectContextTokens = limits.value("ProjectContextTokens", 3000).toInt();
+    m_pinnedFiles = limits.value("PinnedFiles").toStringList();
+
+    // Por defecto solo se cachean las peticiones deterministas (temperature 0)
+    m_cacheAllResponses = limits.value("CacheAllResponses", false).toBool();
+    if (limits.value("ResponseCache", true).toBool()) {
+        m_responseCache.setMaxSize(limits.value("ResponseCacheMaxMB", 64).toLongLong() * 1024 * 1024);
+        m_responseCache.open(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                             + "/DeepSeekPlugin/responses");
+    }
+    limits.endGroup();
+
+    // La cola solo es noticia cuando una petición esperó demasiado; cada
+    // encolado y cada respuesta no merecen una línea
+    connect(m_scheduler, &DeepSeekRequestScheduler::statsChanged,
+            this, [this](const DeepSeekRequestScheduler::Stats &stats) {
+        if (stats.dispatched == m_reportedDispatch || stats.lastWaitMs < m_queueWaitWarningMs)
+            return;
+        m_reportedDispatch = stats.dispatched;
+        Utils::MessageHelper::showMessage(
+            tr("Cola DeepSeek: %1 en espera, %2 en curso, espera media %3 ms (máx. %4 ms)")
+                .arg(stats.queued).arg(stats.running)
+                .arg(stats.averageWaitMs()).arg(stats.maxWaitMs),
+            Utils::MessageHelper::Silent
+            );
+    });
+
+    connect(m_projectAnalyzer, &DeepSeekProjectAnalyzer::progressChanged,
+            this, &DeepSeekTool::progressChanged);
+    connect(m_projectAnalyzer, &DeepSeekProjectAnalyzer::failed, this, [this](const QString &error) {
+        Utils::MessageHelper::showMessage(error, Utils::MessageHelper::Disrupt);
+        emit errorOccurred(error);
+        emit progressChanged(0);
+    });
+
+    connect(m_projectSearch, &DeepSeekProjectSearch::indexReady,
+            this, [this](int files, int documents, int terms, qint64 elapsedMs) {
+        Utils::MessageHelper::showMessage(
+            tr("Índice de búsqueda: %1 archivos, %2 fragmentos, %3 términos en %4 ms")
+                .arg(files).arg(documents).arg(terms).arg(elapsedMs),
+            Utils::MessageHelper::Silent
+            );
+        rebuildStablePrefix();
+    });
+    connect(m_projectSearch, &DeepSeekProjectSearch::filesSkipped,
+            this, [](int files, qint64 bytesSaved) {
+        Utils::MessageHelper::showMessage(
+            tr("Índice de búsqueda: %1 archivos descartados (binarios, generados o grandes), %2 MB sin leer")
+                .arg(files).arg(bytesSaved / (1024.0 * 1024.0), 0, 'f', 1),
+            Utils::MessageHelper::Silent
+            );
+    });
+    connect(m_projectSearch, &DeepSeekProjectSearch::indexUpdated,
+            this, [this](int changed, int removed, qint64 elapsedMs) {
+        Utils::MessageHelper::showMessage(
+            tr("Índice de búsqueda actualizado: %1 archivos cambiados, %2 eliminados en %3 ms")
+                .arg(changed).arg(removed).arg(elapsedMs),
+            Utils::MessageHelper::Silent
+            );
+        rebuildStablePrefix();
+    });
+    connect(m_projectSearch, &DeepSeekProjectSearch::indexCleared,
+            this, &DeepSeekTool::rebuildStablePrefix);
+
+    connect(m_scheduler, &DeepSeekRequestScheduler::retryScheduled,
+            this, [](quint64 requestId, int attempt, int delayMs) {
+        Utils::MessageHelper::showMessage(
+            tr("Petición %1: reintento %2 en %3 ms").arg(requestId).arg(attempt).arg(delayMs),
+            Utils::MessageHelper::Silent
+            );
+    });
+
+    // Ficheros fijados en sesiones anteriores, aún sin proyecto indexado
+    rebuildStablePrefix();
 }
 
 DeepSeekTool::~DeepSeekTool()
 {
+    m_responseCache.close();
     m_networkManager->deleteLater();
 }
 
@@ -40,15 +148,35 @@ void DeepSeekTool::initialize()
         return;
     }
 
-    connect(m_networkManager, &QNetworkAccessManager::finished,
-            this, &DeepSeekTool::onRequestFinished);
-
     connect(m_networkManager, &QNetworkAccessManager::sslErrors,
             this, &DeepSeekTool::onSslErrors);
 
+    // El servidor cierra las conexiones inactivas; mientras haya actividad
+    // reciente se reabren antes de que haga falta
+    m_keepAliveTimer->setInterval(45000);
+    connect(m_keepAliveTimer, &QTimer::timeout, this, [this]() {
+        if (m_lastActivity.isValid() && m_lastActivity.elapsed() < 10 * 60 * 1000)
+            warmUpConnection();
+    });
+    m_keepAliveTimer->start();
+
     m_isInitialized = true;
 }
 
+void DeepSeekTool::warmUpConnection()
+{
+    const QUrl url(m_baseUrl);
+    if (url.scheme() == "https") {
+        // ALPN con h2 para que las peticiones concurrentes compartan la conexión
+        QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+        config.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                        QSslConfiguration::NextProtocolHttp1_1});
+        m_networkManager->connectToHostEncrypted(url.host(), quint16(url.port(443)), config);
+    } else {
+        m_networkManager->connectToHost(url.host(), quint16(url.port(80)));
+    }
+}
+
 void DeepSeekTool::setApiKey(const QString &apiKey)
 {
     if (m_apiKey != apiKey) {
@@ -63,12 +191,28 @@ QString DeepSeekTool::apiKey() const
     return m_apiKey;
 }
 
+void DeepSeekTool::setStreamingEnabled(bool enabled)
+{
+    if (m_streamingEnabled != enabled) {
+        m_streamingEnabled = enabled;
+        DeepSeekSettingsDialog::saveStreamingEnabled(enabled);
+    }
+}
+
+bool DeepSeekTool::streamingEnabled() const
+{
+    return m_streamingEnabled;
+}
+
 void DeepSeekTool::showSettingsDialog(QWidget *parent)
 {
     DeepSeekSettingsDialog dialog(parent);
     dialog.setApiKey(m_apiKey);
+    dialog.setStreamingEnabled(m_streamingEnabled);
 
     if (dialog.exec() == QDialog::Accepted) {
+        setStreamingEnabled(dialog.streamingEnabled());
+
         QString newApiKey = dialog.apiKey();
         if (newApiKey != m_apiKey) {
             m_apiKey = newApiKey;
@@ -95,44 +239,226 @@ void DeepSeekTool::showSettingsDialog(QWidget *parent)
     // }
 }
 
-void DeepSeekTool::sendRequest(const QString &prompt, const QString &mode)
+DeepSeekRequest *DeepSeekTool::sendRequest(const QString &prompt, const QString &mode)
 {
-    // if (!m_isInitialized) {
-    //     emit errorOccurred(tr("DeepSeekTool not initialized"));
-    //     return;
-    // }
+    // Cuerpo de la petición según el modo
+    ChatCompletionRequest chat;
+    QString system;
+    if (isFixMode(mode))
+        system = "Eres un asistente de corrección de código. Proporciona SOLO el código corregido sin explicaciones adicionales.";
+    if (m_stablePromptPrefix && !m_stablePrefix.isEmpty()) {
+        // Lo que no cambia entre peticiones va delante y es igual para todos
+        // los modos: DeepSeek cobra menos y responde antes el prefijo que ya
+        // tiene en su caché de contexto
+        system = system.isEmpty() ? m_stablePrefix : m_stablePrefix + "\n\n" + system;
+    }
+    if (!system.isEmpty())
+        chat.messages.append({"system", system});
+    chat.messages.append({"user", retrieveContext(prompt) + prompt});
+
+    // Las correcciones son deterministas: misma entrada, misma salida (y cacheable)
+    chat.temperature = isFixMode(mode) ? 0.0 : 0.7;
+    chat.maxTokens = 2000;
+    if (isFixMode(mode)) {
+        // La respuesta es el código completo: algo más que el código enviado
+        const int codeTokens = DeepSeekTokenEstimator::upperBound(
+            DeepSeekTokenEstimator::estimate(prompt));
+        chat.maxTokens = qBound(2000, codeTokens + codeTokens / 4 + 256,
+                                DeepSeekTokenEstimator::MaxOutputTokens);
+    }
 
-    // if (m_apiKey.isEmpty()) {
-    //     emit errorOccurred(tr("API Key not configured"));
-    //     return;
-    // }
+    return submitRequest(chat, mode);
+}
 
-    // if (prompt.isEmpty()) {
-    //     emit errorOccurred(tr("Prompt cannot be empty"));
-    //     return;
-    // }
+QString DeepSeekTool::retrieveContext(const QString &query) const
+{
+    if (m_retrievalSnippets <= 0 || !m_projectSearch->isReady())
+        return {};
+
+    QElapsedTimer timer;
+    timer.start();
+    // Algunos resultados pueden ser el propio código del prompt
+    const QList<DeepSeekSearchIndex::Hit> hits = m_projectSearch->search(query, m_retrievalSnippets * 2);
+    const qint64 searchMs = timer.elapsed();
+
+    QList<const DeepSeekSearchIndex::Hit *> selected;
+    QStringList blocks;
+    int usedTokens = 0;
+    for (const DeepSeekSearchIndex::Hit &hit : hits) {
+        if (selected.size() == m_retrievalSnippets)
+            break;
+        if (query.contains(hit.text.trimmed()))
+            continue;
+        // Los ficheros fijados ya van enteros en el prefijo estable
+        if (m_stablePromptPrefix && m_pinnedFiles.contains(hit.path))
+            continue;
 
+        const QString block = QString("==== %1:%2-%3 ====\n%4\n")
+                                  .arg(hit.path, QString::number(hit.firstLine),
+                                       QString::number(hit.lastLine), hit.text);
+        const int tokens = DeepSeekTokenEstimator::estimate(block);
+        if (usedTokens + tokens > m_retrievalTokens)
+            continue;
+        selected.append(&hit);
+        blocks.append(block);
+        usedTokens += tokens;
+    }
 
+    if (selected.isEmpty())
+        return {};
+
+    const int taken = int(selected.size());
+    QString context;
+    if (m_stablePromptPrefix) {
+        // Orden por fichero y línea, no por puntuación: consultas parecidas
+        // producen el mismo texto y alargan el prefijo común
+        QList<int> order(taken);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&selected](int a, int b) {
+            return std::tie(selected.at(a)->path, selected.at(a)->firstLine)
+                   < std::tie(selected.at(b)->path, selected.at(b)->firstLine);
+        });
+        for (int i : std::as_const(order))
+            context += blocks.at(i);
+    } else {
+        context = blocks.join(QString());
+    }
 
-    // QUrl apiUrl(m_baseUrl + getEndpointForMode(mode));
-    // QNetworkRequest request(apiUrl);
+    Utils::MessageHelper::showMessage(
+        tr("Contexto del proyecto: %1 fragmentos (~%2 tokens), búsqueda en %3 ms")
+            .arg(taken).arg(usedTokens).arg(searchMs),
+        Utils::MessageHelper::Silent
+        );
+    return "Relevant code from the current project (for reference only, do not modify it):\n"
+           + context + "\n";
+}
 
-    // request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    // if (!m_apiKey.isEmpty()) {
-    //     request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
-    // }
+void DeepSeekTool::setPinnedFiles(const QStringList &paths)
+{
+    QStringList pinned = paths;
+    pinned.sort();
+    pinned.removeDuplicates();
+    if (pinned == m_pinnedFiles)
+        return;
 
-    // QJsonObject payload = buildPayload(prompt);
-    // QJsonDocument doc(payload);
-    // QByteArray data = doc.toJson();
+    m_pinnedFiles = pinned;
+    QSettings settings;
+    settings.beginGroup("DeepSeekPlugin");
+    settings.setValue("PinnedFiles", m_pinnedFiles);
+    settings.endGroup();
+    rebuildStablePrefix();
+}
 
-    // QNetworkReply *reply = m_networkManager->post(request, data);
-    // connect(reply, &QNetworkReply::errorOccurred,
-    //         this, &DeepSeekTool::onNetworkError);
+bool DeepSeekTool::togglePinnedFile(const QString &path)
+{
+    QStringList pinned = m_pinnedFiles;
+    const bool pin = !pinned.removeOne(path);
+    if (pin)
+        pinned.append(path);
+    setPinnedFiles(pinned);
+    return pin;
+}
 
-    // emit progressChanged(10);
+void DeepSeekTool::rebuildStablePrefix()
+{
+    m_stablePrefix.clear();
+    if (!m_stablePromptPrefix || m_projectContextTokens <= 0)
+        return;
 
+    // Todo en orden determinista (rutas ordenadas) y sin nada que cambie
+    // entre peticiones: ni fechas, ni contadores, ni la consulta
+    const std::shared_ptr<const DeepSeekSearchIndex> index = m_projectSearch->index();
+    const QStringList files = index ? index->filePaths() : QStringList();
+    QString prefix;
+    int usedTokens = 0;
+
+    if (!files.isEmpty()) {
+        // Directorio común: el primer y el último fichero (están ordenados)
+        const QString &first = files.first();
+        const QString &last = files.last();
+        qsizetype common = 0;
+        while (common < first.size() && common < last.size() && first.at(common) == last.at(common))
+            ++common;
+        if (files.size() == 1)
+            common = first.size();
+        common = common > 0 ? first.lastIndexOf('/', common - 1) + 1 : 0;
+
+        prefix += "Files of the current project:\n";
+        // La lista no debe dejar sin sitio a los ficheros fijados
+        const int listBudget = m_pinnedFiles.isEmpty() ? m_projectContextTokens
+                                                       : m_projectContextTokens / 2;
+        for (qsizetype i = 0; i < files.size(); ++i) {
+            const QString line = files.at(i).mid(common) + '\n';
+            const int tokens = DeepSeekTokenEstimator::estimate(line);
+            if (usedTokens + tokens > listBudget) {
+                prefix += QString("... %1 more files\n").arg(files.size() - i);
+                break;
+            }
+            prefix += line;
+            usedTokens += tokens;
+        }
+    }
 
+    int pinnedCount = 0;
+    for (const QString &path : std::as_const(m_pinnedFiles)) {
+        // Del índice si está (la versión ya leída), si no del disco
+        const QByteArrayView indexed = index ? index->fileContent(path) : QByteArrayView();
+        QString content;
+        if (!indexed.isEmpty()) {
+            content = QString::fromUtf8(indexed);
+        } else {
+            QFile source(path);
+            if (!source.open(QIODevice::ReadOnly))
+                continue;
+            content = QString::fromUtf8(source.readAll());
+        }
+
+        const QString block = QString("\n==== %1 ====\n%2\n").arg(path, content);
+        const int tokens = DeepSeekTokenEstimator::estimate(block);
+        if (usedTokens + tokens > m_projectContextTokens)
+            continue;
+        if (pinnedCount == 0)
+            prefix += "\nPinned files:\n";
+        prefix += block;
+        usedTokens += tokens;
+        ++pinnedCount;
+    }
+
+    if (prefix.isEmpty())
+        return;
+    m_stablePrefix = "Project context (reference only):\n" + prefix;
+
+    Utils::MessageHelper::showMessage(
+        tr("Prefijo estable del prompt: ~%1 tokens, %2 de %3 ficheros fijados")
+            .arg(usedTokens).arg(pinnedCount).arg(m_pinnedFiles.size()),
+        Utils::MessageHelper::Silent
+        );
+}
+
+void DeepSeekTool::reportPromptCache(quint64 requestId, const ChatCompletionUsage &usage)
+{
+    if (usage.promptCacheHitTokens < 0 || usage.promptCacheMissTokens < 0)
+        return;
+
+    m_promptCacheHitTokens += usage.promptCacheHitTokens;
+    m_promptCacheMissTokens += usage.promptCacheMissTokens;
+    const qint64 total = m_promptCacheHitTokens + m_promptCacheMissTokens;
+    const qint64 requestTotal = usage.promptCacheHitTokens + usage.promptCacheMissTokens;
+
+    Utils::MessageHelper::showMessage(
+        tr("Caché de contexto: petición %1 %2% (%3 de %4 tokens), sesión %5% (%6 de %7)")
+            .arg(requestId)
+            .arg(requestTotal > 0 ? 100 * usage.promptCacheHitTokens / requestTotal : 0)
+            .arg(usage.promptCacheHitTokens).arg(requestTotal)
+            .arg(total > 0 ? 100 * m_promptCacheHitTokens / total : 0)
+            .arg(m_promptCacheHitTokens).arg(total),
+        Utils::MessageHelper::Silent
+        );
+    emit promptCacheStatsChanged(m_promptCacheHitTokens, m_promptCacheMissTokens);
+}
+
+DeepSeekRequest *DeepSeekTool::submitRequest(ChatCompletionRequest chat, const QString &mode)
+{
     // 1. Validación de API Key
     if (m_apiKey.isEmpty()) {
         Utils::MessageHelper::showMessage(
@@ -140,93 +466,223 @@ void DeepSeekTool::sendRequest(const QString &prompt, const QString &mode)
             Utils::MessageHelper::Disrupt
             );
         emit errorOccurred(tr("Configuración requerida"));
-        return;
+        return nullptr;
     }
 
-    // 2. Mostrar estado de progreso
-    emit progressChanged(10);
+    // 2. El prompt tiene que caber en el contexto junto con la respuesta;
+    //    mejor saberlo aquí que con un 400 después de subirlo entero. La
+    //    estimación lleva margen: si se queda corta, max_tokens aún cabe
+    const int promptTokens = DeepSeekTokenEstimator::upperBound(
+        DeepSeekTokenEstimator::estimate(chat));
+    const int availableTokens = m_contextTokens - promptTokens;
+    if (availableTokens < 256) {
+        const QString error = tr("El prompt es demasiado grande: ~%1 tokens de %2 disponibles")
+                                  .arg(promptTokens).arg(m_contextTokens);
+        Utils::MessageHelper::showMessage(error, Utils::MessageHelper::Disrupt);
+        emit errorOccurred(error);
+        return nullptr;
+    }
+    chat.maxTokens = qMin(chat.maxTokens, availableTokens);
+
+    m_lastActivity.start();
+
+    // Los pasos intermedios del análisis no se muestran: su progreso lo
+    // informa DeepSeekProjectAnalyzer
+    const bool analysisStep = mode == Constants::ANALYSIS_CHUNK_MODE;
+
+    // 3. Mostrar estado de progreso
+    if (!analysisStep)
+        emit progressChanged(10);
     Utils::MessageHelper::showMessage(
         tr("Procesando solicitud: %1").arg(mode),
         Utils::MessageHelper::Silent
         );
 
-    // 3. Configurar la solicitud HTTP
-    QNetworkRequest request(QUrl("https://api.deepseek.com/v1/chat/completions"));
+    // 4. Configurar la solicitud HTTP
+    QNetworkRequest request(QUrl(m_baseUrl + "/chat/completions"));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
+    // HTTP/2: varias peticiones multiplexadas sobre la conexión precalentada
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    // 5. La clave de caché cubre modelo, mensajes, temperature y max_tokens, no "stream"
+    QByteArray cacheKey;
+    if (m_responseCache.isOpen() && (chat.temperature == 0.0 || m_cacheAllResponses))
+        cacheKey = DeepSeekResponseCache::keyFor(DeepSeekPayloadWriter::write(chat, false));
+
+    chat.stream = m_streamingEnabled && !analysisStep;
+    if (chat.stream)
+        request.setRawHeader("Accept", "text/event-stream");
+
+    // 6. Crear el handle de la petición; no se bloquea esperando la respuesta
+    auto *handle = new DeepSeekRequest(++m_lastRequestId, mode, this);
+    handle->setNetworkRequest(request, DeepSeekPayloadWriter::write(chat), chat.stream);
+    handle->setTimeout(30000);
+
+    connect(handle, &DeepSeekRequest::partialContent, this, [this, handle](const QString &chunk) {
+        if (handle->content().size() == chunk.size())
+            emit progressChanged(50);
+        emit partialResponseReceived(chunk);
+    });
 
-    // 4. Construir cuerpo JSON según el modo
-    QJsonObject json;
-    json["model"] = "deepseek-chat";
+    connect(handle, &DeepSeekRequest::finished, this, [this, handle](const QString &content) {
+        emit requestTimingsAvailable(handle->mode(), handle->connectionSetupMs(),
+                                     handle->firstTokenMs(), handle->totalMs());
+        if (!handle->isFromCache()) {
+            Utils::MessageHelper::showMessage(
+                tr("Petición %1: conexión %2 ms%3, primer token %4 ms, total %5 ms")
+                    .arg(handle->id())
+                    .arg(handle->connectionSetupMs())
+                    .arg(handle->usedHttp2() ? QStringLiteral(" (HTTP/2)") : QString())
+                    .arg(handle->firstTokenMs())
+                    .arg(handle->totalMs()),
+                Utils::MessageHelper::Silent
+                );
+            const ChatCompletionUsage usage = handle->usage();
+            if (usage.isValid()) {
+                Utils::MessageHelper::showMessage(
+                    tr("Petición %1: %2 tokens de prompt, %3 de respuesta (%4)")
+                        .arg(handle->id())
+                        .arg(usage.promptTokens)
+                        .arg(usage.completionTokens)
+                        .arg(handle->finishReason()),
+                    Utils::MessageHelper::Silent
+                    );
+                reportPromptCache(handle->id(), usage);
+            }
+        }
+        if (handle->mode() == Constants::ANALYSIS_CHUNK_MODE)
+            return; // El resultado lo recoge DeepSeekProjectAnalyzer
+        processContent(content, handle->mode());
+        emit progressChanged(100);
+    });
 
-    if (mode == "fix") {
-        json["messages"] = QJsonArray({
-            QJsonObject({
-                {"role", "system"},
-                {"content", "Eres un asistente de corrección de código. Proporciona SOLO el código corregido sin explicaciones adicionales."}
-            }),
-            QJsonObject({
-                {"role", "user"},
-                {"content", prompt}
-            })
-        });
-    } else {
-        json["messages"] = QJsonArray({
-            QJsonObject({
-                {"role", "user"},
-                {"content", prompt}
-            })
+    connect(handle, &DeepSeekRequest::failed, this, [this, handle]() {
+        handleNetworkError(handle);
+    });
+
+    connect(handle, &DeepSeekRequest::cancelled, this, [this, handle]() {
+        // Los fragmentos los cancela DeepSeekProjectAnalyzer al parar, y
+        // él ya informa del progreso: sin un error por fragmento
+        if (handle->mode() == Constants::ANALYSIS_CHUNK_MODE)
+            return;
+        emit errorOccurred(tr("Solicitud cancelada"));
+        emit progressChanged(0);
+    });
+
+    const quint64 id = handle->id();
+    connect(handle, &DeepSeekRequest::completed, this, [this, id]() {
+        m_requests.remove(id);
+        emit activeRequestsChanged(m_requests.size());
+    });
+
+    m_requests.insert(id, handle);
+
+    if (!cacheKey.isEmpty()) {
+        QString cached;
+        if (m_responseCache.lookup(cacheKey, &cached)) {
+            reportCacheStats();
+            handle->startFromCache(cached);
+            emit activeRequestsChanged(m_requests.size());
+            return handle;
+        }
+
+        connect(handle, &DeepSeekRequest::finished, this, [this, cacheKey](const QString &content) {
+            m_responseCache.insert(cacheKey, content);
+            reportCacheStats();
         });
     }
 
-    json["temperature"] = 0.7;
-    json["max_tokens"] = 2000;
+    m_scheduler->enqueue(handle, priorityForMode(mode));
+    emit activeRequestsChanged(m_requests.size());
 
-    // 5. Enviar solicitud asíncrona con timeout
-    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(json).toJson());
-    reply->setProperty("requestMode", mode);  // Almacena el modo
+    return handle;
+}
 
-    QTimer timeoutTimer;
-    timeoutTimer.setSingleShot(true);
-    QEventLoop loop;
+DeepSeekRequest *DeepSeekTool::requestCompletion(const QString &prefix, const QString &suffix)
+{
+    if (m_apiKey.isEmpty())
+        return nullptr;
 
-    // 6. Configurar timeout (30 segundos)
-    timeoutTimer.start(30000);
-    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    connect(&timeoutTimer, &QTimer::timeout, [&]() {
-        if (reply->isRunning()) {
-            reply->abort();
-            Utils::MessageHelper::showMessage(
-                tr("Timeout: La solicitud excedió el tiempo límite"),
-                Utils::MessageHelper::Disrupt
-                );
-        }
-    });
+    m_lastActivity.start();
 
-    // 7. Manejar respuesta
-    connect(reply, &QNetworkReply::finished, this, [this, reply, mode, &loop]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            handleNetworkError(reply);
-            loop.quit();
-            return;
-        }
+    // FIM solo existe en la API beta: .../v1 -> .../beta/completions
+    QString baseUrl = m_baseUrl;
+    if (baseUrl.endsWith("/v1"))
+        baseUrl.chop(3);
+    QNetworkRequest request(QUrl(baseUrl + "/beta/completions"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    FimCompletionRequest fim;
+    fim.prompt = prefix;
+    fim.suffix = suffix;
+
+    // Fuera del planificador y de m_requests: cada pausa al escribir no debe
+    // gastar el token bucket de Generate/Fix ni aparecer como petición
+    // activa (ni caer con cancelAllRequests()). Quien la pide la cancela
+    auto *handle = new DeepSeekRequest(++m_lastRequestId, Constants::INLINE_COMPLETION_MODE, this);
+    handle->setNetworkRequest(request, DeepSeekPayloadWriter::write(fim), fim.stream);
+    handle->setTimeout(5000);
+    handle->start(m_networkManager);
+
+    return handle;
+}
 
-        QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
-        processApiResponse(response, mode);
-        loop.quit();
-    });
+DeepSeekRequestScheduler::Priority DeepSeekTool::priorityForMode(const QString &mode)
+{
+    if (isFixMode(mode) || mode == "code")
+        return DeepSeekRequestScheduler::Interactive;
+    if (mode == "analysis" || mode == Constants::ANALYSIS_CHUNK_MODE)
+        return DeepSeekRequestScheduler::Background;
+    return DeepSeekRequestScheduler::Normal;
+}
 
-    loop.exec();
+bool DeepSeekTool::isFixMode(const QString &mode)
+{
+    return mode == "fix" || mode == Constants::SCOPED_FIX_MODE;
+}
 
-    // 8. Limpieza
-    reply->deleteLater();
-    emit progressChanged(100);
+void DeepSeekTool::reportCacheStats()
+{
+    const DeepSeekResponseCache::Stats stats = m_responseCache.stats();
+    Utils::MessageHelper::showMessage(
+        tr("Caché de respuestas: %1 aciertos, %2 fallos (%3 entradas, %4 KB)")
+            .arg(stats.hits).arg(stats.misses)
+            .arg(stats.entries).arg(stats.liveBytes / 1024),
+        Utils::MessageHelper::Silent
+        );
+}
+
+void DeepSeekTool::cancelRequest(quint64 requestId)
+{
+    if (DeepSeekRequest *handle = m_requests.value(requestId))
+        handle->cancel();
+}
+
+void DeepSeekTool::cancelAllRequests()
+{
+    // cancel() elimina la entrada de m_requests a través de completed()
+    const QList<DeepSeekRequest *> handles = m_requests.values();
+    for (DeepSeekRequest *handle : handles)
+        handle->cancel();
+}
+
+int DeepSeekTool::activeRequestCount() const
+{
+    return m_requests.size();
 }
 
-void DeepSeekTool::handleNetworkError(QNetworkReply *reply)
+void DeepSeekTool::handleNetworkError(DeepSeekRequest *request)
 {
     QString errorMsg;
-    switch (reply->error()) {
+    switch (request->networkError()) {
+    case QNetworkReply::NoError:
+        // La respuesta llegó, pero su contenido no es válido
+        errorMsg = request->errorString();
+        break;
     case QNetworkReply::TimeoutError:
         errorMsg = tr("Timeout al conectar con DeepSeek API");
         break;
@@ -234,7 +690,11 @@ void DeepSeekTool::handleNetworkError(QNetworkReply *reply)
         errorMsg = tr("API Key inválida. Verifique en Settings");
         break;
     default:
-        errorMsg = tr("Error de red: %1").arg(reply->errorString());
+        if (request->httpStatus() == 429) {
+            errorMsg = tr("Límite de peticiones alcanzado tras %1 intentos").arg(request->attempt());
+            break;
+        }
+        errorMsg = tr("Error de red: %1").arg(request->errorString());
     }
 
     Utils::MessageHelper::showMessage(errorMsg, Utils::MessageHelper::Disrupt);
@@ -242,66 +702,54 @@ void DeepSeekTool::handleNetworkError(QNetworkReply *reply)
     emit progressChanged(0);
 }
 
-void DeepSeekTool::requestFix(const QString &code, const QString &problemDescription)
+DeepSeekRequest *DeepSeekTool::requestFix(const QString &code, const QString &problemDescription)
 {
     QString prompt = QString("Fix the following code:\n\n%1\n\nProblem: %2\n\n"
                            "Provide only the complete fixed code without additional explanations.")
                     .arg(code)
                     .arg(problemDescription);
 
-    sendRequest(prompt, "fix");
+    return sendRequest(prompt, "fix");
 }
 
-void DeepSeekTool::requestProjectAnalysis(const QMap<QString, QString> &projectContents)
+DeepSeekRequest *DeepSeekTool::requestScopedFix(const DeepSeekFixScope &scope,
+                                                const QString &problemDescription)
 {
-    QString prompt = "Analyze this Qt project and provide:\n";
-    prompt += "1. Architecture suggestions\n";
-    prompt += "2. Performance improvements\n";
-    prompt += "3. Modern Qt practices to apply\n";
-    prompt += "4. Potential bugs\n\n";
-    prompt += "Project structure:\n";
-
-    for (const QString &filePath : projectContents.keys()) {
-        prompt += "- " + filePath + "\n";
-    }
-
-    prompt += "\nKey files content:\n";
-    int fileCount = 0;
-    for (const auto &[path, content] : projectContents.asKeyValueRange()) {
-        if (fileCount++ > 10) break; // Limit to 10 files to avoid huge prompts
-        if (path.endsWith(".cpp") || path.endsWith(".h") || path.endsWith(".qml")) {
-            prompt += QString("\n==== %1 ====\n%2\n").arg(path).arg(content.left(1000));
-        }
+    if (!scope.isValid())
+        return nullptr;
+
+    // Solo se devuelve el fragmento: la salida no crece con el fichero
+    QString prompt = QString("File: %1\n\n").arg(scope.filePath);
+    if (!scope.declarations.isEmpty())
+        prompt += QString("Declarations from the top of the file (reference only):\n%1\n")
+                      .arg(scope.declarations);
+    if (!scope.before.isEmpty())
+        prompt += QString("Code before the fragment (reference only):\n%1\n").arg(scope.before);
+    prompt += QString("Fragment to fix (lines %1-%2):\n<<<FRAGMENT\n%3FRAGMENT>>>\n\n")
+                  .arg(scope.firstLine).arg(scope.lastLine).arg(scope.code);
+    if (!scope.after.isEmpty())
+        prompt += QString("Code after the fragment (reference only):\n%1\n").arg(scope.after);
+    prompt += QString("Problem: %1\n\n"
+                      "Provide only the fixed fragment, complete and with its original "
+                      "indentation, without the surrounding code, markers or explanations.")
+                  .arg(problemDescription);
+
+    DeepSeekRequest *handle = sendRequest(prompt, Constants::SCOPED_FIX_MODE);
+    if (handle) {
+        connect(handle, &DeepSeekRequest::finished, this, [this, scope](const QString &content) {
+            emit scopedFixReady(scope, content);
+        });
     }
-
-    sendRequest(prompt, "analysis");
+    return handle;
 }
 
-void DeepSeekTool::onRequestFinished(QNetworkReply *reply)
+bool DeepSeekTool::analyzeProjectFiles(const QString &projectFilePath, const QStringList &paths)
 {
-    reply->deleteLater();
-    emit progressChanged(90);
-
-    // Manejo de errores mejorado
-    if (reply->error() != QNetworkReply::NoError) {
-        handleNetworkError(reply);  // Usa la función de manejo de errores existente
-        emit progressChanged(0);
-        return;
-    }
-
-    // Obtener el modo del userData (más seguro que de la URL)
-    QString mode = reply->property("requestMode").toString();
-
-    // Procesar respuesta
-    QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-    if (jsonResponse.isNull()) {
-        emit errorOccurred(tr("Respuesta JSON inválida"));
-        emit progressChanged(0);
-        return;
+    if (!m_projectAnalyzer->start(projectFilePath, paths)) {
+        emit errorOccurred(tr("Ya hay un análisis de proyecto en curso"));
+        return false;
     }
-
-    processApiResponse(jsonResponse, mode);  // Nueva función
-    emit progressChanged(100);
+    return m_projectAnalyzer->isRunning();
 }
 
 void DeepSeekTool::onSslErrors(QNetworkReply *reply, const QList<QSslError> &errors)
@@ -323,92 +771,9 @@ void DeepSeekTool::onSslErrors(QNetworkReply *reply, const QList<QSslError> &err
 //     }
 // }
 
-void DeepSeekTool::processApiResponse(const QJsonDocument &response, const QString &mode) {
-    // // 1. Validación estricta
-    // if (!response.isObject()) {
-    //     emit errorOccurred(tr("Respuesta no es objeto JSON"));
-    //     return;
-    // }
-
-    // QJsonObject obj = response.object();
-    // if (!obj.contains("choices") || !obj["choices"].isArray()) {
-    //     emit errorOccurred(tr("Formato de respuesta inválido (falta 'choices')"));
-    //     return;
-    // }
-
-    // QJsonArray choices = obj["choices"].toArray();
-    // if (choices.isEmpty()) {
-    //     emit errorOccurred(tr("La API no devolvió resultados"));
-    //     return;
-    // }
-
-    // // 2. Extracción segura con value()
-    // QString content = choices.first().toObject()
-    //                       .value("message").toObject()
-    //                       .value("content").toString();
-
-    // if (content.isEmpty()) {
-    //     emit errorOccurred(tr("Contenido vacío en la respuesta"));
-    //     return;
-    // }
-
-    // // 3. Manejo de modos con enum (más seguro que strings)
-    // if (mode == "fix") {
-    //     emit fixReady(content);
-    // } else if (mode == "analysis") {
-    //     emit projectAnalysisReady(parseAnalysis(content)); // Procesamiento adicional
-    // } else { // "generate" o cualquier otro
-    //     emit responseReceived(content);
-    // }
-
-    // // 4. Notificación profesional
-    // Utils::MessageHelper::showMessage(
-    //     QString("%1 completado: %2 caracteres")
-    //         .arg(mode == "fix" ? "Corrección" : "Generación")
-    //         .arg(content.length()),
-    //     Utils::MessageHelper::Flash
-    //     );
-
-    // 1. Validación básica del JSON
-    if (!response.isObject()) {
-        emit errorOccurred(tr("Invalid JSON response format"));
-        Utils::MessageHelper::showMessage(
-            "Error: La respuesta no es un objeto JSON válido",
-            Utils::MessageHelper::Disrupt
-            );
-        return;
-    }
-
-    QJsonObject obj = response.object();
-
-    // 2. Validar estructura esperada de la API
-    if (!obj.contains("choices") || !obj["choices"].isArray()) {
-        QString errorMsg = tr("API response missing 'choices' array");
-        emit errorOccurred(errorMsg);
-        Utils::MessageHelper::showMessage(
-            QString("Error de API: %1").arg(errorMsg),
-            Utils::MessageHelper::Disrupt
-            );
-        return;
-    }
-
-    QJsonArray choices = obj["choices"].toArray();
-    if (choices.isEmpty()) {
-        emit errorOccurred(tr("Empty choices array in response"));
-        return;
-    }
-
-    // 3. Extracción segura del contenido
-    QJsonObject firstChoice = choices.first().toObject();
-    QJsonObject message = firstChoice.value("message").toObject();
-    QString content = message.value("content").toString();
-
-    if (content.isEmpty()) {
-        emit errorOccurred(tr("Empty content in API response"));
-        return;
-    }
-
-    // 4. Procesamiento según el modo
+void DeepSeekTool::processContent(const QString &content, const QString &mode)
+{
+    // Procesamiento según el modo
     if (mode == "fix") {
         emit fixReady(content.trimmed());
         Utils::MessageHelper::showMessage(
@@ -416,6 +781,13 @@ void DeepSeekTool::processApiResponse(const QJsonDocument &response, const QStri
             Utils::MessageHelper::Flash
             );
     }
+    else if (mode == Constants::SCOPED_FIX_MODE) {
+        // Lo aplica quien recibe scopedFixReady(), que conoce el fragmento
+        Utils::MessageHelper::showMessage(
+            "✓ Fragmento corregido listo",
+            Utils::MessageHelper::Flash
+            );
+    }
     else if (mode == "analysis") {
         QJsonObject analysisResult = parseAnalysis(content);
 
@@ -442,7 +814,7 @@ void DeepSeekTool::processApiResponse(const QJsonDocument &response, const QStri
             );
     }
 
-    // 5. Registro de depuración (solo en modo debug)
+    // Registro de depuración (solo en modo debug)
 #ifdef QT_DEBUG
     qDebug() << "API Response processed - Mode:" << mode
              << "Content size:" << content.size();
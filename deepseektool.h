@@ -4,7 +4,17 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QJsonObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "deepseeksettingsdialog.h"
+#include "deepseekrequest.h"
+#include "deepseekrequestscheduler.h"
+#include "deepseekresponsecache.h"
+#include "deepseekpayloadwriter.h"
+#include "deepseekprojectanalyzer.h"
+#include "deepseekprojectsearch.h"
+#include "deepseekfixscope.h"
 #include <coreplugin/messagemanager.h>
 
 namespace DeepSeekAI {
@@ -24,24 +34,71 @@ public:
 
     QString apiKey() const;
 
+    void setStreamingEnabled(bool enabled);
+    bool streamingEnabled() const;
+
     void showSettingsDialog(QWidget *parent);
 
+    int activeRequestCount() const;
+    DeepSeekRequestScheduler *scheduler() const { return m_scheduler; }
+    DeepSeekProjectAnalyzer *projectAnalyzer() const { return m_projectAnalyzer; }
+    DeepSeekProjectSearch *projectSearch() const { return m_projectSearch; }
+
+    // Ficheros que van enteros en el prefijo estable de cada prompt
+    QStringList pinnedFiles() const { return m_pinnedFiles; }
+    void setPinnedFiles(const QStringList &paths);
+    // Devuelve si path queda fijado
+    bool togglePinnedFile(const QString &path);
+
+    // Tokens de prompt servidos desde la caché de contexto de DeepSeek en la sesión
+    qint64 promptCacheHitTokens() const { return m_promptCacheHitTokens; }
+    qint64 promptCacheMissTokens() const { return m_promptCacheMissTokens; }
+
+    // Envía un cuerpo de chat ya construido; el modo decide prioridad y
+    // qué señal recibe el resultado
+    DeepSeekRequest *submitRequest(ChatCompletionRequest chat, const QString &mode);
+    // Completado fill-in-the-middle en /beta/completions, siempre en
+    // streaming y sin mensajes ni progreso: se pide en cada pausa al
+    // escribir. No pasa por el planificador ni cuenta como petición activa;
+    // quien la pide es dueño de cancelarla. nullptr si no hay API Key
+    DeepSeekRequest *requestCompletion(const QString &prefix, const QString &suffix);
+
 public slots:
-    void sendRequest(const QString &prompt, const QString &mode);
-    void requestFix(const QString &code, const QString &problemDescription);
-    void requestProjectAnalysis(const QMap<QString, QString> &projectContents);
+    // Devuelven el handle de la petición (nullptr si no se pudo enviar).
+    // El handle se elimina solo cuando la petición termina.
+    DeepSeekRequest *sendRequest(const QString &prompt, const QString &mode);
+    DeepSeekRequest *requestFix(const QString &code, const QString &problemDescription);
+    // Solo envía scope (con su contexto) y pide solo su sustitución; el
+    // resultado llega por scopedFixReady()
+    DeepSeekRequest *requestScopedFix(const DeepSeekAI::Internal::DeepSeekFixScope &scope,
+                                      const QString &problemDescription);
+    // Analiza el proyecto por fragmentos en paralelo (ver DeepSeekProjectAnalyzer):
+    // lee los ficheros y reutiliza lo ya analizado del proyecto; el resultado
+    // llega por projectAnalysisReady()
+    bool analyzeProjectFiles(const QString &projectFilePath, const QStringList &paths);
+
+    void cancelRequest(quint64 requestId);
+    void cancelAllRequests();
+
+    // Abre en segundo plano la conexión TLS (HTTP/2) con la API
+    void warmUpConnection();
 
 signals:
     void responseReceived(const QString &response);
+    void partialResponseReceived(const QString &chunk);
+    void requestTimingsAvailable(const QString &mode, qint64 connectMs, qint64 firstTokenMs,
+                                 qint64 totalMs);
     void fixReady(const QString &fixedCode);
+    void scopedFixReady(const DeepSeekAI::Internal::DeepSeekFixScope &scope, const QString &fixedCode);
     void projectAnalysisReady(const QJsonObject &analysis);
     void errorOccurred(const QString &error);
     void progressChanged(int progress);
     void settingsChanged(bool apiKeyValid);
+    void activeRequestsChanged(int count);
+    void promptCacheStatsChanged(qint64 hitTokens, qint64 missTokens);
 
 
 private slots:
-    void onRequestFinished(QNetworkReply *reply);
     void onSslErrors(QNetworkReply *reply, const QList<QSslError> &errors);
     // void onNetworkError(QNetworkReply::NetworkError code);
 
@@ -53,11 +110,53 @@ private:
     // QString getEndpointForMode(const QString &mode) const;
 
     QNetworkAccessManager *m_networkManager;
+    DeepSeekRequestScheduler *m_scheduler;
+    DeepSeekProjectAnalyzer *m_projectAnalyzer;
+    DeepSeekProjectSearch *m_projectSearch;
     QString m_apiKey;
     QString m_baseUrl;
     bool m_isInitialized;
-    void handleNetworkError(QNetworkReply *reply);
-    void processApiResponse(const QJsonDocument &response, const QString &mode);
+    bool m_streamingEnabled;
+    int m_contextTokens;
+
+    // Espera en cola a partir de la cual se informa (ver statsChanged)
+    int m_queueWaitWarningMs = 1000;
+    quint64 m_reportedDispatch = 0;
+
+    int m_retrievalSnippets = 6;
+    int m_retrievalTokens = 2000;
+
+    // Prefijo estable: estructura del proyecto y ficheros fijados, siempre
+    // primero y en el mismo orden (ver rebuildStablePrefix)
+    bool m_stablePromptPrefix = true;
+    int m_projectContextTokens = 3000;
+    QStringList m_pinnedFiles;
+    QString m_stablePrefix;
+
+    qint64 m_promptCacheHitTokens = 0;
+    qint64 m_promptCacheMissTokens = 0;
+
+    DeepSeekResponseCache m_responseCache;
+    bool m_cacheAllResponses = false;
+
+    // Peticiones en curso, indexadas por id
+    QHash<quint64, DeepSeekRequest *> m_requests;
+    quint64 m_lastRequestId = 0;
+
+    // Mantiene viva la conexión mientras la sesión se esté usando
+    QTimer *m_keepAliveTimer;
+    QElapsedTimer m_lastActivity;
+
+    void handleNetworkError(DeepSeekRequest *request);
+    static DeepSeekRequestScheduler::Priority priorityForMode(const QString &mode);
+    static bool isFixMode(const QString &mode);
+    void reportCacheStats();
+    void processContent(const QString &content, const QString &mode);
+    // Fragmentos del proyecto relevantes para query (BM25), listos para
+    // anteponer al prompt; vacío si no hay índice o nada relevante
+    QString retrieveContext(const QString &query) const;
+    void rebuildStablePrefix();
+    void reportPromptCache(quint64 requestId, const ChatCompletionUsage &usage);
 
     QJsonObject parseAnalysis(const QString &apiResponse);
     QJsonObject extractKeySections(const QString &content);
@@ -9,6 +9,7 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QStandardPaths>
+#include <QTextCursor>
 
 namespace DeepSeekAI {
 namespace Internal {
@@ -18,8 +19,11 @@ DeepSeekWidget::DeepSeekWidget(QWidget *parent)
       m_promptEdit(new QPlainTextEdit(this)),
       m_responseEdit(new QPlainTextEdit(this)),
       m_generateCodeButton(new QPushButton(tr("Generate Code"), this)),
+      m_streamToEditorCheck(new QCheckBox(tr("Into editor"), this)),
       m_fixCodeButton(new QPushButton(tr("Fix Code"), this)),
+      m_fixScopeCheck(new QCheckBox(tr("At cursor"), this)),
       m_generateProjectButton(new QPushButton(tr("Generate Project"), this)),
+      m_cancelButton(new QPushButton(tr("Cancel"), this)),
       m_projectTypeCombo(new QComboBox(this)),
       m_buildSystemCombo(new QComboBox(this)),
       m_progressBar(new QProgressBar(this)),
@@ -76,8 +80,16 @@ void DeepSeekWidget::setupUI()
     // Action Buttons
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(m_generateCodeButton);
+    m_streamToEditorCheck->setToolTip(tr("Insert the generated code at the cursor as it arrives; "
+                                         "cancelling removes it"));
+    buttonLayout->addWidget(m_streamToEditorCheck);
     buttonLayout->addWidget(m_fixCodeButton);
+    m_fixScopeCheck->setChecked(true);
+    m_fixScopeCheck->setToolTip(tr("Fix only the selection or the function at the cursor "
+                                   "instead of the whole file"));
+    buttonLayout->addWidget(m_fixScopeCheck);
     buttonLayout->addWidget(m_generateProjectButton);
+    buttonLayout->addWidget(m_cancelButton);
     buttonLayout->addStretch();
     buttonLayout->addWidget(m_settingsButton);
 
@@ -106,6 +118,8 @@ void DeepSeekWidget::setupUI()
     mainLayout->addWidget(responseLabel);
     mainLayout->addWidget(m_responseEdit);
 
+    m_cancelButton->setEnabled(false);
+
     // Status Bar
     m_progressBar->setRange(0, 100);
     m_progressBar->setVisible(false);
@@ -156,8 +170,18 @@ void DeepSeekWidget::setupConnections()
     connect(m_buildSystemCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &DeepSeekWidget::onBuildSystemChanged);
 
+    connect(m_cancelButton, &QPushButton::clicked,
+            m_tool, &DeepSeekTool::cancelAllRequests);
+
     connect(m_tool, &DeepSeekTool::projectAnalysisReady,
             this, &DeepSeekWidget::handleAnalysisResults);
+    connect(m_tool, &DeepSeekTool::activeRequestsChanged,
+            this, &DeepSeekWidget::onActiveRequestsChanged);
+    connect(m_tool->projectAnalyzer(), &DeepSeekProjectAnalyzer::chunkProgress,
+            this, [this](int finishedChunks, int totalChunks) {
+        m_statusLabel->setText(tr("Analizando proyecto: %1 de %2 fragmentos")
+                                   .arg(finishedChunks).arg(totalChunks));
+    });
 }
 
 // Implementación del slot
@@ -233,6 +257,18 @@ void DeepSeekWidget::onFixCodeClicked()
         return;
     }
 
+    // Por defecto solo la función del cursor: prompt y respuesta no crecen
+    // con el tamaño del fichero
+    if (m_fixScopeCheck->isChecked()) {
+        const DeepSeekFixScope scope = m_plugin->codeEditor()->currentFixScope();
+        if (scope.isValid()) {
+            m_progressBar->setVisible(true);
+            m_statusLabel->setText(tr("Fixing lines %1-%2").arg(scope.firstLine).arg(scope.lastLine));
+            emit requestScopedFix(scope, prompt);
+            return;
+        }
+    }
+
     const QString currentCode = m_plugin->codeEditor()->currentFileContent();
     m_progressBar->setVisible(true);
     emit requestFixCode(currentCode, prompt);
@@ -276,18 +312,55 @@ void DeepSeekWidget::onBuildSystemChanged(int index)
 
 void DeepSeekWidget::onResponseReceived(const QString &response)
 {
+    m_streamingResponse = false;
     m_responseEdit->setPlainText(response);
     m_progressBar->setVisible(false);
 }
 
+void DeepSeekWidget::onPartialResponseReceived(const QString &chunk)
+{
+    // El primer fragmento reemplaza la respuesta anterior
+    if (!m_streamingResponse) {
+        m_streamingResponse = true;
+        m_responseEdit->clear();
+    }
+
+    QTextCursor cursor = m_responseEdit->textCursor();
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(chunk);
+    m_responseEdit->ensureCursorVisible();
+}
+
+void DeepSeekWidget::onRequestTimings(const QString &mode, qint64 connectMs, qint64 firstTokenMs,
+                                      qint64 totalMs)
+{
+    QString text = mode + ": ";
+    if (connectMs > 0)
+        text += tr("connect %1 ms, ").arg(connectMs);
+    else if (connectMs == 0)
+        text += tr("reused connection, ");
+
+    if (firstTokenMs >= 0)
+        text += tr("first token %1 ms, total %2 ms").arg(firstTokenMs).arg(totalMs);
+    else
+        text += tr("total %1 ms").arg(totalMs);
+
+    m_statusLabel->setText(text);
+}
+
 void DeepSeekWidget::onErrorOccurred(const QString &error)
 {
+    m_streamingResponse = false;
     m_responseEdit->appendPlainText(tr("Error: %1").arg(error));
     m_progressBar->setVisible(false);
 }
 
 void DeepSeekWidget::onProgressChanged(int progress){
     m_progressBar->setValue(progress);
+    // 100 al terminar (también fix, que no pasa por onResponseReceived) y 0
+    // al cancelar: el siguiente stream vuelve a empezar con el panel limpio
+    if (progress == 100 || progress == 0)
+        m_streamingResponse = false;
 }
 
 void DeepSeekWidget::onProjectGenerated(const QString &projectPath){
@@ -297,6 +370,11 @@ void DeepSeekWidget::onProjectGenerated(const QString &projectPath){
     updateGenerateProjectUI();
 }
 
+void DeepSeekWidget::onActiveRequestsChanged(int count)
+{
+    m_cancelButton->setEnabled(count > 0);
+}
+
 void DeepSeekWidget::onSettingsChanged(bool apiKeyValid) {
     // Actualizar UI basado en la validez de la API Key
     m_generateCodeButton->setEnabled(apiKeyValid);
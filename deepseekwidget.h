@@ -4,11 +4,13 @@
 #include <QPlainTextEdit>
 #include <QPushButton>
 #include <QToolButton>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QProgressBar>
 #include <QStackedWidget>
 #include <QLabel>
 
+#include "deepseekfixscope.h"
 #include "deepseekprojectgenerator.h"
 
 namespace DeepSeekAI {
@@ -28,19 +30,27 @@ public:
 
     void initialize(DeepSeekTool *tool, DeepSeekProjectGenerator *projectGenerator, DeepSeekPlugin *plugin);
     void prepareShutdown();
+    // Generate Code escribe la respuesta en el editor según llega
+    bool streamsIntoEditor() const { return m_streamToEditorCheck->isChecked(); }
 
 public slots:
     void onResponseReceived(const QString &response);
+    void onPartialResponseReceived(const QString &chunk);
+    void onRequestTimings(const QString &mode, qint64 connectMs, qint64 firstTokenMs,
+                          qint64 totalMs);
     void onErrorOccurred(const QString &error);
     void onProgressChanged(int progress);
     void onProjectGenerated(const QString &projectPath);
 
     void onSettingsChanged(bool apiKeyValid);  // Slot para actualizar la UI
+    void onActiveRequestsChanged(int count);
 
     void handleAnalysisResults(const QJsonObject &results);
 signals:
     void requestGenerated(const QString &prompt, const QString &mode);
     void requestFixCode(const QString &code, const QString &description);
+    void requestScopedFix(const DeepSeekAI::Internal::DeepSeekFixScope &scope,
+                          const QString &description);
     void requestProjectGeneration(const QString &projectName,
                                   const QString &projectPath,
                                   DeepSeekProjectGenerator::BuildSystem buildSystem,
@@ -70,8 +80,11 @@ private:
     QPlainTextEdit *m_promptEdit;
     QPlainTextEdit *m_responseEdit;
     QPushButton *m_generateCodeButton;
+    QCheckBox *m_streamToEditorCheck;
     QPushButton *m_fixCodeButton;
+    QCheckBox *m_fixScopeCheck;
     QPushButton *m_generateProjectButton;
+    QPushButton *m_cancelButton;
     QComboBox *m_projectTypeCombo;
     QComboBox *m_buildSystemCombo;
     QProgressBar *m_progressBar;
@@ -79,6 +92,8 @@ private:
     QLabel *m_statusLabel;
 
     QToolButton *m_settingsButton;
+
+    bool m_streamingResponse = false;
 };
 
 } // namespace Internal